@@ -1,11 +1,15 @@
 #include "daisysp.h"
 #include "daisy_patch.h"
-#include "audio/osc_voice.h"
+#include "audio/voice_bank.h"
 #include "audio/simple_reverb.h"
 #include "audio/scale_quantizer.h"
 #include "audio/chord_progression.h"
 #include "audio/axis_mapping.h"
-#include "boids/boids.h"
+#include "audio/boid_motion.h"
+#include "boids/flock.h"
+#include "boids/flock_trace.h"
+#include "storage/qspi_flash.h"
+#include "storage/rig_snapshot.h"
 #include "ui/display.h"
 #include "ui/led_grid.h"
 #include <cmath>
@@ -13,18 +17,34 @@
 using namespace daisy;
 using namespace daisysp;
 
+#if defined(MURMUR_FLOCK_IN_AUDIO) && (defined(MURMUR_UI_ONLY) || defined(MURMUR_TRACE))
+#error "MURMUR_FLOCK_IN_AUDIO steps the flock in the audio callback: not with UI-only or trace builds"
+#endif
+
 // Hardware
 DaisyPatch patch;
 
-// Oscillator voices (one per boid)
-murmur::OscVoice voices[murmur::MAX_BOIDS];
+// Oscillator voices (one per boid) and their band-limited waveforms. UI-only builds
+// allocate none.
+#ifndef MURMUR_UI_ONLY
+murmur::MorphWavetable wavetable;
+murmur::VoiceBank<murmur::MAX_BOIDS> voices;
+
+// Latest flock state for the audio callback, and the callback's running sample count
+// (the clock snapshots are stamped and extrapolated against)
+murmur::BoidMotion<murmur::MAX_BOIDS> motion;
+volatile uint32_t sample_clock = 0;
+
+// Audio callback time as a share of the block period (PARAMETERS page)
+CpuLoadMeter cpu_meter;
+#endif
 
 // Shared reverb bus for z-axis distance simulation (mono in, mono out)
 murmur::SimpleReverb reverb;
 constexpr float REVERB_LEVEL = 0.4f;
 
 // Boids
-murmur::BoidsFlock flock;
+murmur::Flock flock;
 murmur::BoidsParams boids_params;
 
 // UI
@@ -52,42 +72,128 @@ constexpr float FREQ_MIN = 200.0f;
 constexpr float FREQ_MAX = 800.0f;
 constexpr float MAX_AMP_TOTAL = 0.8f;  // Total max amplitude across all voices
 
+// Boid count limits (encoder range), clamped to this build's flock capacity
+constexpr int MAX_NUM_BOIDS = static_cast<int>(murmur::MAX_BOIDS);
+constexpr int MIN_NUM_BOIDS = MAX_NUM_BOIDS < 4 ? MAX_NUM_BOIDS : 4;
+
 // State
-int num_boids = 8;
+constexpr int DEFAULT_NUM_BOIDS = MAX_NUM_BOIDS < 8 ? MAX_NUM_BOIDS : 8;
+int num_boids = DEFAULT_NUM_BOIDS;
 float sample_rate = 48000.0f;
 
+// Knobs are handled as events: one per move of at least KNOB_EVENT_STEP (of 65535) or on
+// reaching an end stop. Trace builds use a 1/1024 deadband so ADC noise does not fill the
+// capture; other builds apply every change of the reading, as before events.
+#ifdef MURMUR_TRACE
+constexpr int32_t KNOB_EVENT_STEP = 64;
+#else
+constexpr int32_t KNOB_EVENT_STEP = 1;
+#endif
+int32_t knob_values[4] = {-1, -1, -1, -1};  // last applied, -1 = not read yet
+
+// Warm start: settings and flock are saved to the last 64 KB of QSPI flash (one snapshot
+// per 4 KB sector, round-robin) and restored at power-up before audio starts. Settings
+// changes are saved once they have rested for SNAPSHOT_SETTLE_MS, the flock in flight once
+// per SNAPSHOT_PERIOD_MS: each sector then sees one erase per 16 minutes of play.
+constexpr uint32_t SNAPSHOT_FLASH_BASE = 0x7F0000;
+constexpr uint32_t SNAPSHOT_SECTORS    = 16;
+constexpr uint32_t SNAPSHOT_SETTLE_MS  = 3000;
+constexpr uint32_t SNAPSHOT_PERIOD_MS  = 60000;
+murmur::QspiFlash snapshot_flash(patch.seed.qspi);
+murmur::SnapshotStore<murmur::QspiFlash> snapshot_store;
+murmur::RigSnapshot snapshot;
+murmur::RigSettings snapshot_settings;   // latest settings seen by UpdateSnapshot()
+bool     snapshot_settings_dirty = false;  // changed since the last save
+uint32_t snapshot_settings_ms    = 0;      // when they last changed
+uint32_t last_snapshot_ms        = 0;
+
+#ifdef MURMUR_TRACE
+// Performance trace (make trace): one capture from power-up in SDRAM, until it fills or
+// GATE_1 first starts replaying it. Replay resets to the power-up control state and feeds
+// the recorded events and flock steps through the live paths; GATE_1 again (or the end
+// of the trace) returns to live play, and the next GATE_1 replays the capture again.
+constexpr size_t TRACE_BUFFER_BYTES = 16 * 1024 * 1024;
+DSY_SDRAM_BSS uint8_t trace_buffer[TRACE_BUFFER_BYTES];
+murmur::TraceWriter trace_writer;
+murmur::TraceReader trace_reader;
+size_t   trace_captured   = 0;      // capture size once recording has ended
+murmur::TraceRecord trace_next;     // next record to replay
+bool     trace_next_valid = false;
+bool     trace_replaying  = false;
+uint32_t trace_replay_start = 0;
+int      trace_chord_mode  = 0;     // last recorded chord state
+int      trace_chord_index = 0;
+murmur::RigSettings trace_power_up;  // settings the capture started from (warm or cold)
+#endif
+
 // Timing
 uint32_t last_display_update = 0;
 uint32_t last_boids_update = 0;
 constexpr uint32_t DISPLAY_UPDATE_MS = 33;
 constexpr uint32_t BOIDS_UPDATE_MS = 2;
 
+#ifdef MURMUR_FLOCK_IN_AUDIO
+// Flock in the audio callback (make audio-flock): the flock steps at block boundaries on
+// the sample clock instead of being polled from the main loop, so OLED transfers no longer
+// shift its timing. Cost cap: at most this many steps per block; a longer backlog (only
+// possible with blocks longer than a step) is dropped like Advance()'s catch-up backlog.
+constexpr size_t FLOCK_STEPS_PER_BLOCK = 1;
+#endif
+
 void UpdateControls();
+void HandleControl(const murmur::TraceEvent& event);
+void ApplyControl(const murmur::TraceEvent& event);
+void SetBoidCount(int count);
+void StepFlock(uint32_t now);
+#ifdef MURMUR_FLOCK_IN_AUDIO
+void StepFlockInAudio(uint32_t block_start, size_t block_size);
+#endif
+bool LoadSnapshot();
+void UpdateSnapshot(uint32_t now);
 void UpdateDisplay();
-void UpdateVoicesFromBoids();
+#ifdef MURMUR_TRACE
+void StartReplay(uint32_t now);
+void StopReplay();
+void ReplayTrace(uint32_t now);
+#endif
+void UpdateVoicesFromMotion(uint32_t now, size_t block_size);
 
 #ifndef MURMUR_UI_ONLY
 static void AudioCallback(AudioHandle::InputBuffer in,
                           AudioHandle::OutputBuffer out,
                           size_t size) {
-    for (size_t i = 0; i < size; i++) {
-        float sum_l  = 0.0f;
-        float sum_r  = 0.0f;
-        float rev_in = 0.0f;
-
-        for (size_t v = 0; v < static_cast<size_t>(num_boids); v++) {
-            sum_l  += voices[v].ProcessLeft();
-            sum_r  += voices[v].ProcessRight();
-            rev_in += voices[v].GetReverbSend();
+    cpu_meter.OnBlockStart();
+    const uint32_t block_start = sample_clock;
+#ifdef MURMUR_FLOCK_IN_AUDIO
+    StepFlockInAudio(block_start, size);
+#endif
+    // Voice targets from the boids extrapolated to the middle of this block
+    UpdateVoicesFromMotion(block_start + static_cast<uint32_t>(size / 2), size);
+
+    // Voices render a whole chunk at a time into the L/R and reverb-send buses
+    static float bus_l[murmur::VOICE_MAX_BLOCK];
+    static float bus_r[murmur::VOICE_MAX_BLOCK];
+    static float bus_rev[murmur::VOICE_MAX_BLOCK];
+
+    for (size_t start = 0; start < size; start += murmur::VOICE_MAX_BLOCK) {
+        const size_t n = size - start < murmur::VOICE_MAX_BLOCK ? size - start
+                                                                : murmur::VOICE_MAX_BLOCK;
+        for (size_t i = 0; i < n; i++) {
+            bus_l[i] = bus_r[i] = bus_rev[i] = 0.0f;
+        }
+        voices.ProcessBlock(bus_l, bus_r, bus_rev, n);
+
+        for (size_t i = 0; i < n; i++) {
+            // Mix reverb tail into output — adds spatial depth for far (low-z) boids
+            float rev_out = reverb.Process(bus_rev[i]);
+            out[0][start + i] = bus_l[i] + rev_out * REVERB_LEVEL;
+            out[1][start + i] = bus_r[i] + rev_out * REVERB_LEVEL;
+            out[2][start + i] = in[2][start + i];
+            out[3][start + i] = in[3][start + i];
         }
-
-        // Mix reverb tail into output — adds spatial depth for far (low-z) boids
-        float rev_out = reverb.Process(rev_in);
-        out[0][i] = sum_l + rev_out * REVERB_LEVEL;
-        out[1][i] = sum_r + rev_out * REVERB_LEVEL;
-        out[2][i] = in[2][i];
-        out[3][i] = in[3][i];
     }
+    sample_clock = block_start + static_cast<uint32_t>(size);
+    cpu_meter.OnBlockEnd();
 }
 #endif
 
@@ -97,20 +203,30 @@ int main(void) {
 
     // Initialize oscillator voices and reverb
 #ifndef MURMUR_UI_ONLY
-    for (size_t i = 0; i < murmur::MAX_BOIDS; i++) {
-        voices[i].Init(sample_rate);
-    }
+    wavetable.Init();
+    voices.Init(sample_rate, wavetable);
     reverb.Init(sample_rate);
+    motion.Init(sample_rate);
+    cpu_meter.Init(sample_rate, patch.AudioBlockSize());
 #endif
 
-    // Initialize boids
+    // Initialize boids, from the last snapshot when there is one
+    const bool warm_start = LoadSnapshot();
     flock.Init(num_boids);
+    if (warm_start) murmur::RestoreFlock(flock, snapshot);
     boids_params.separation_weight = density * 2.0f;
     boids_params.cohesion_weight   = (1.0f - density) * 2.0f;
     boids_params.alignment_weight  = alignment_weight;
     boids_params.perception_radius = 0.25f;
     boids_params.max_speed = 0.3f;
     boids_params.max_force = 0.3f * 0.5f;  // coupled: force scales with speed
+    // The M7 FPU is scalar, so visiting each pair once beats the all-pairs sweep;
+    // Verlet lists additionally skip pairs that are nowhere near each other.
+    boids_params.neighbor_search = murmur::NeighborSearch::VERLET;
+    // Slow, loose flocks step less often (up to 8 ms); fast or crowded ones keep 2 ms
+    boids_params.adaptive_step = true;
+    // Far (quiet) and isolated boids steer every 4th step, staggered across the flock
+    boids_params.lod_stride = 4;
 
     // Initialize UI
     display.Init(&patch);
@@ -118,9 +234,14 @@ int main(void) {
 
     // Activate initial voices
 #ifndef MURMUR_UI_ONLY
-    for (int i = 0; i < num_boids; i++) {
-        voices[i].SetActive(true);
-    }
+    voices.SetActive(0, num_boids, true);
+    motion.Publish(flock, sample_clock, num_boids, scale_quantizer);
+#endif
+
+    snapshot_settings = murmur::CaptureSettings(scale_quantizer, chord_prog, axis_mapping, num_boids);
+#ifdef MURMUR_TRACE
+    trace_power_up = snapshot_settings;
+    trace_writer.Init(trace_buffer, TRACE_BUFFER_BYTES);
 #endif
 
     patch.StartAdc();
@@ -133,19 +254,16 @@ int main(void) {
 
         uint32_t now = System::GetNow();
 
-        chord_prog.Update(now, scale_quantizer);
-
-        // Update boids simulation
-        if (now - last_boids_update >= BOIDS_UPDATE_MS) {
-            float dt = static_cast<float>(now - last_boids_update) / 1000.0f;
-            flock.Update(dt, boids_params);
-
-#ifndef MURMUR_UI_ONLY
-            UpdateVoicesFromBoids();
-#endif
-
-            last_boids_update = now;
+#ifdef MURMUR_TRACE
+        if (trace_replaying) {
+            ReplayTrace(now);
+        } else {
+            StepFlock(now);
         }
+#else
+        StepFlock(now);
+#endif
+        UpdateSnapshot(now);
 
         // Update display and LEDs (visual rate)
         if (now - last_display_update >= DISPLAY_UPDATE_MS) {
@@ -156,132 +274,369 @@ int main(void) {
     }
 }
 
-void UpdateVoicesFromBoids() {
+void StepFlock(uint32_t now) {
+    chord_prog.Update(now, scale_quantizer);
+
+#ifdef MURMUR_TRACE
+    if (chord_prog.GetMode() != trace_chord_mode || chord_prog.GetIndex() != trace_chord_index) {
+        trace_chord_mode  = chord_prog.GetMode();
+        trace_chord_index = chord_prog.GetIndex();
+        trace_writer.WriteEvent(now, {murmur::TraceEventType::CHORD,
+                                      static_cast<uint8_t>(trace_chord_mode), trace_chord_index});
+    }
+#endif
+
+#ifndef MURMUR_FLOCK_IN_AUDIO
+    // Update boids simulation: whole 2-8 ms steps, so a slow display or SPI frame
+    // only adds catch-up steps instead of one large, jittery integration step.
+    if (now - last_boids_update >= BOIDS_UPDATE_MS) {
+        float elapsed = static_cast<float>(now - last_boids_update) / 1000.0f;
+        size_t steps = flock.Advance(elapsed, boids_params);
+
+#ifndef MURMUR_UI_ONLY
+        // Hand the newest step to the audio callback, which extrapolates it per block
+        motion.Publish(flock, sample_clock, num_boids, scale_quantizer);
+#endif
+#ifdef MURMUR_TRACE
+        if (steps > 0) trace_writer.WriteFrame(now, flock);
+#else
+        (void)steps;
+#endif
+
+        last_boids_update = now;
+    }
+#endif
+}
+
+#ifdef MURMUR_FLOCK_IN_AUDIO
+// Runs in the audio callback at the start of each block: advances the flock by the
+// block's duration (at most FLOCK_STEPS_PER_BLOCK steps) and publishes new steps for the
+// voice mapping that follows. The flock's clock is then at the end of the block, so
+// that is the time the steps are stamped against. The main loop only reads the flock (display, LEDs,
+// snapshots), which at worst shows one frame mixing two steps; anything that writes it
+// from the main loop blocks interrupts around the write (see SetBoidCount).
+void StepFlockInAudio(uint32_t block_start, size_t block_size) {
+    const float elapsed = static_cast<float>(block_size) / sample_rate;
+    if (flock.Advance(elapsed, boids_params, FLOCK_STEPS_PER_BLOCK) > 0) {
+        motion.Publish(flock, block_start + static_cast<uint32_t>(block_size), num_boids,
+                       scale_quantizer);
+    }
+}
+#endif
+
+// Boot, before the flock is created: restores the settings and boid count of the newest
+// compatible snapshot into the globals. False (defaults kept) if there is none.
+bool LoadSnapshot() {
+    snapshot_store.Init(&snapshot_flash, SNAPSHOT_FLASH_BASE, SNAPSHOT_SECTORS);
+    if (!snapshot_store.Load(murmur::RIG_SNAPSHOT_VERSION, &snapshot, sizeof(snapshot))) {
+        return false;
+    }
+    murmur::ApplySettings(snapshot.settings, System::GetNow(), scale_quantizer, chord_prog,
+                          axis_mapping);
+    num_boids = snapshot.settings.num_boids;
+    if (num_boids < MIN_NUM_BOIDS) num_boids = MIN_NUM_BOIDS;
+    if (num_boids > MAX_NUM_BOIDS) num_boids = MAX_NUM_BOIDS;
+    return true;
+}
+
+// Main loop: advances a pending flash write by one operation (see SnapshotStore) and
+// starts a new save when settings have settled or the periodic save is due.
+void UpdateSnapshot(uint32_t now) {
+    snapshot_store.Poll();
+#ifdef MURMUR_TRACE
+    if (trace_replaying) return;  // keep the rig's own state, not the recording's
+#endif
+
+    const murmur::RigSettings settings =
+        murmur::CaptureSettings(scale_quantizer, chord_prog, axis_mapping, num_boids);
+    if (!murmur::SameSettings(settings, snapshot_settings)) {
+        snapshot_settings_dirty = true;
+        snapshot_settings_ms    = now;
+    }
+    snapshot_settings = settings;
+
+    const bool due = snapshot_settings_dirty ? now - snapshot_settings_ms >= SNAPSHOT_SETTLE_MS
+                                             : now - last_snapshot_ms >= SNAPSHOT_PERIOD_MS;
+    if (!due || snapshot_store.IsBusy()) return;
+
+    snapshot.settings = settings;
+    murmur::CaptureFlock(flock, snapshot);
+    if (snapshot_store.Save(murmur::RIG_SNAPSHOT_VERSION, &snapshot, sizeof(snapshot))) {
+        snapshot_settings_dirty = false;
+        last_snapshot_ms        = now;
+    }
+}
+
+#ifdef MURMUR_TRACE
+void StartReplay(uint32_t now) {
+    // The first replay ends the capture; later ones replay the same capture again
+    if (trace_captured == 0) {
+        trace_captured = trace_writer.GetSize();
+        trace_writer.Init(nullptr, 0);
+    }
+    if (!trace_reader.Init(trace_buffer, trace_captured)) return;
+
+    // Back to the power-up control state the capture started from
+    murmur::ApplySettings(trace_power_up, now, scale_quantizer, chord_prog, axis_mapping);
+    settings_cursor = 0;
+    display.SetPage(murmur::DisplayPage::FLOCK_VIEW);
+    SetBoidCount(trace_power_up.num_boids);
+
+    trace_replaying    = true;
+    trace_replay_start = now;
+    trace_next_valid   = trace_reader.Next(trace_next);
+}
+
+void StopReplay() {
+    trace_replaying = false;
+    last_boids_update = System::GetNow();
+    // Re-read every knob so live play resumes from the hardware, not the recording
+    for (int32_t& k : knob_values) k = -1;
+}
+
+void ReplayTrace(uint32_t now) {
+    const uint32_t t = now - trace_replay_start;
+    while (trace_next_valid && trace_next.time_ms <= t) {
+        if (trace_next.type == murmur::TraceRecordType::EVENT) {
+            ApplyControl(trace_next.event);
+        } else {
+            // Events precede their frames, so the boid counts already agree
+            size_t n = trace_reader.GetNumBoids();
+            if (n > flock.GetNumBoids()) n = flock.GetNumBoids();
+            for (size_t i = 0; i < n; i++) {
+                flock.SetBoidState(i, trace_reader.GetPosition(i), trace_reader.GetVelocity(i));
+            }
+#ifndef MURMUR_UI_ONLY
+            motion.Publish(trace_reader, sample_clock, num_boids, scale_quantizer);
+#endif
+        }
+        trace_next_valid = trace_reader.Next(trace_next);
+    }
+    if (!trace_next_valid) StopReplay();
+}
+#endif
+
+#ifndef MURMUR_UI_ONLY
+// Runs in the audio callback, once per block: maps each boid's extrapolated position at
+// sample-clock time now to its voice and advances the voice smoothing by one block,
+// including the fade-out of released voices.
+void UpdateVoicesFromMotion(uint32_t now, size_t block_size) {
+    const float ticks = static_cast<float>(block_size)
+                      / (sample_rate * static_cast<float>(BOIDS_UPDATE_MS) * 0.001f);
+    // Count and scale come from the snapshot: the main loop may be changing the globals
+    const int count = static_cast<int>(motion.GetNumBoids());
+    const murmur::ScaleQuantizer& scale = motion.GetScale();
+
     murmur::MappingContext ctx = {
-        scale_quantizer,
+        scale,
         FREQ_MIN,
         freq_range,
         span_octaves,
-        MAX_AMP_TOTAL / static_cast<float>(num_boids)
+        MAX_AMP_TOTAL / static_cast<float>(motion.GetNumVoices())
     };
 
-    for (int i = 0; i < num_boids; i++) {
-        const murmur::Boid& boid = flock.GetBoid(i);
-        murmur::VoiceParams vp = MapBoidToVoice(boid.position, axis_mapping, ctx);
+    for (int i = 0; i < count; i++) {
+        murmur::Vec3 pos = motion.Extrapolate(i, now);
+        murmur::VoiceParams vp = MapBoidToVoice(pos, axis_mapping, ctx);
 
-        // boid.position.z is passed as depth hint regardless of axis assignment —
-        // OscVoice uses it for filter brightness and reverb send scaling.
-        voices[i].SetParams(vp.freq, vp.amp, vp.pan, boid.position.z);
-        voices[i].SetMorph(morph);
+        // pos.z is passed as depth hint regardless of axis assignment —
+        // the voice uses it for filter brightness and reverb send scaling.
+        voices.SetParams(i, vp.freq, vp.amp, vp.pan, pos.z);
+        voices.SetMorph(i, morph);
         // In scale mode, snap freq immediately so boids land on discrete notes
         // rather than gliding through them (amp/pan still smooth normally).
-        if (scale_quantizer.GetScale() != murmur::ScaleType::OFF) {
-            voices[i].SnapFreq(vp.freq);
+        if (scale.GetScale() != murmur::ScaleType::OFF) {
+            voices.SnapFreq(i, vp.freq);
         }
-        voices[i].UpdateSmoothing();
+        voices.UpdateSmoothing(i, ticks);
     }
+    voices.UpdateReleased(ticks);
 }
+#endif
 
 void UpdateControls() {
     patch.ProcessAnalogControls();
     patch.ProcessDigitalControls();
 
-    // === KNOBS ===
-    // CTRL_1: Density — CCW = min separation (cluster), CW = max separation (spread)
-    density = patch.GetKnobValue(DaisyPatch::CTRL_1);
-    boids_params.separation_weight = density * 2.0f;
-    boids_params.cohesion_weight   = (1.0f - density) * 2.0f;
+    // Knobs
+    for (int k = 0; k < 4; k++) {
+        float raw = patch.GetKnobValue(static_cast<DaisyPatch::Ctrl>(k));
+        int32_t value = static_cast<int32_t>(raw * 65535.0f + 0.5f);
+        if (value < 0) value = 0;
+        if (value > 65535) value = 65535;
+
+        int32_t last  = knob_values[k];
+        int32_t moved = value > last ? value - last : last - value;
+        bool    stop  = (value == 0 || value == 65535) && value != last;
+        if (last < 0 || moved >= KNOB_EVENT_STEP || stop) {
+            HandleControl({murmur::TraceEventType::KNOB, static_cast<uint8_t>(k), value});
+        }
+    }
+
+    // Encoder
+    int inc = patch.encoder.Increment();
+    if (inc != 0) {
+        HandleControl({murmur::TraceEventType::ENCODER_TURN, 0, inc});
+    }
+    if (patch.encoder.RisingEdge()) {
+        HandleControl({murmur::TraceEventType::ENCODER_PRESS, 0, 0});
+    }
 
-    // CTRL_2: Alignment weight (0-2)
-    alignment_weight = patch.GetKnobValue(DaisyPatch::CTRL_2) * 2.0f;
-    boids_params.alignment_weight = alignment_weight;
+    // GATE_2: Scatter flock (randomize positions)
+    if (patch.gate_input[1].Trig()) {
+        HandleControl({murmur::TraceEventType::GATE, 1, 0});
+    }
 
-    // CTRL_3: Speed (max_speed 0.05-1.5); max_force coupled so boids can reach target speed
-    boids_params.max_speed = 0.05f + patch.GetKnobValue(DaisyPatch::CTRL_3) * 1.45f;
-    boids_params.max_force = boids_params.max_speed * 0.5f;
+    // GATE_1: trace builds toggle replay of the capture; otherwise reserved
+#ifdef MURMUR_TRACE
+    if (patch.gate_input[0].Trig()) {
+        if (trace_replaying) {
+            StopReplay();
+        } else {
+            StartReplay(System::GetNow());
+        }
+    }
+#endif
+}
 
-    // CTRL_4: Waveform morph (0=sine, 1=triangle, 2=square)
-    morph = patch.GetKnobValue(DaisyPatch::CTRL_4) * 2.0f;
+// Live control input: recorded into the trace, then applied. While a trace replays,
+// the hardware is ignored (except GATE_1) and the recorded events are applied instead.
+void HandleControl(const murmur::TraceEvent& event) {
+#ifdef MURMUR_TRACE
+    if (trace_replaying) return;
+    trace_writer.WriteEvent(System::GetNow(), event);
+#endif
+    ApplyControl(event);
+}
 
-    // === ENCODER ===
-    int inc = patch.encoder.Increment();
+// Changes the flock / voice count, clamped to the encoder range
+void SetBoidCount(int count) {
+#ifndef MURMUR_UI_ONLY
+    int old_num = num_boids;
+#endif
+    num_boids = count;
+    if (num_boids < MIN_NUM_BOIDS) num_boids = MIN_NUM_BOIDS;
+    if (num_boids > MAX_NUM_BOIDS) num_boids = MAX_NUM_BOIDS;
+    {
+#ifdef MURMUR_FLOCK_IN_AUDIO
+        ScopedIrqBlocker block_audio;  // not while the callback is mid-step
+#endif
+        flock.SetNumBoids(num_boids);
+    }
 
-    if (display.GetPage() == murmur::DisplayPage::SCALE_SETTINGS) {
-        // On Scale Settings page: encoder navigates/edits settings.
-        if (inc != 0) {
-            switch (settings_cursor) {
-                case 0: {
-                    // Root: wrap 0-11
-                    int r = ((scale_quantizer.GetRoot() + inc) % 12 + 12) % 12;
-                    scale_quantizer.SetRoot(r);
+#ifndef MURMUR_UI_ONLY
+    ScopedIrqBlocker block_audio;  // the callback walks the live voice list
+    if (num_boids > old_num) {
+        voices.SetActive(old_num, num_boids, true);
+    } else {
+        voices.SetActive(num_boids, old_num, false);
+    }
+    // The callback maps only the published voice count, so publish the new one now rather
+    // than at the next step (blocked: MURMUR_FLOCK_IN_AUDIO also publishes from the callback)
+    motion.Publish(flock, sample_clock, num_boids, scale_quantizer);
+#endif
+}
+
+void ApplyControl(const murmur::TraceEvent& event) {
+    switch (event.type) {
+        case murmur::TraceEventType::KNOB: {
+            if (event.index >= 4) break;
+            knob_values[event.index] = event.value;
+            float value = static_cast<float>(event.value) / 65535.0f;
+
+            switch (event.index) {
+                case 0:
+                    // CTRL_1: Density — CCW = min separation (cluster), CW = max separation (spread)
+                    density = value;
+                    boids_params.separation_weight = density * 2.0f;
+                    boids_params.cohesion_weight   = (1.0f - density) * 2.0f;
                     break;
-                }
-                case 1: {
-                    // Scale type: wrap 0 to COUNT-1
-                    int s = ((static_cast<int>(scale_quantizer.GetScale()) + inc)
-                             % static_cast<int>(murmur::ScaleType::COUNT)
-                             + static_cast<int>(murmur::ScaleType::COUNT))
-                            % static_cast<int>(murmur::ScaleType::COUNT);
-                    scale_quantizer.SetScale(static_cast<murmur::ScaleType>(s));
+                case 1:
+                    // CTRL_2: Alignment weight (0-2)
+                    alignment_weight = value * 2.0f;
+                    boids_params.alignment_weight = alignment_weight;
                     break;
-                }
                 case 2:
-                    // Base octave: clamp 1-5
-                    scale_quantizer.SetBaseOctave(scale_quantizer.GetBaseOctave() + inc);
-                    break;
-                case 3:
-                    chord_prog.Increment(inc, System::GetNow(), scale_quantizer);
+                    // CTRL_3: Speed (max_speed 0.05-1.5); max_force coupled so boids can reach target speed
+                    boids_params.max_speed = 0.05f + value * 1.45f;
+                    boids_params.max_force = boids_params.max_speed * 0.5f;
                     break;
                 default:
+                    // CTRL_4: Waveform morph (0=sine, 1=triangle, 2=square)
+                    morph = value * 2.0f;
                     break;
             }
+            break;
         }
 
-        // Press: advance cursor; after chord prog row exit back to Flock View
-        if (patch.encoder.RisingEdge()) {
-            if (settings_cursor < 3) {
-                settings_cursor++;
+        case murmur::TraceEventType::ENCODER_TURN: {
+            int inc = event.value;
+            if (display.GetPage() == murmur::DisplayPage::SCALE_SETTINGS) {
+                // On Scale Settings page: encoder navigates/edits settings.
+                switch (settings_cursor) {
+                    case 0: {
+                        // Root: wrap 0-11
+                        int r = ((scale_quantizer.GetRoot() + inc) % 12 + 12) % 12;
+                        scale_quantizer.SetRoot(r);
+                        break;
+                    }
+                    case 1: {
+                        // Scale type: wrap 0 to COUNT-1
+                        int s = ((static_cast<int>(scale_quantizer.GetScale()) + inc)
+                                 % static_cast<int>(murmur::ScaleType::COUNT)
+                                 + static_cast<int>(murmur::ScaleType::COUNT))
+                                % static_cast<int>(murmur::ScaleType::COUNT);
+                        scale_quantizer.SetScale(static_cast<murmur::ScaleType>(s));
+                        break;
+                    }
+                    case 2:
+                        // Base octave: clamp 1-5
+                        scale_quantizer.SetBaseOctave(scale_quantizer.GetBaseOctave() + inc);
+                        break;
+                    case 3:
+                        chord_prog.Increment(inc, System::GetNow(), scale_quantizer);
+                        break;
+                    default:
+                        break;
+                }
             } else {
-                settings_cursor = 0;
-                display.NextPage();  // exits SCALE_SETTINGS → FLOCK_VIEW
+                // All other pages: encoder changes boid count
+                SetBoidCount(num_boids + inc);
             }
+            break;
         }
-    } else {
-        // All other pages: encoder changes boid count + cycles page.
-        if (inc != 0) {
-#ifndef MURMUR_UI_ONLY
-            int old_num = num_boids;
-#endif
-            num_boids += inc;
-            if (num_boids < 4)  num_boids = 4;
-            if (num_boids > 16) num_boids = 16;
-            flock.SetNumBoids(num_boids);
 
-#ifndef MURMUR_UI_ONLY
-            if (num_boids > old_num) {
-                for (int i = old_num; i < num_boids; i++) {
-                    voices[i].SetActive(true);
+        case murmur::TraceEventType::ENCODER_PRESS:
+            if (display.GetPage() == murmur::DisplayPage::SCALE_SETTINGS) {
+                // Advance cursor; after chord prog row exit back to Flock View
+                if (settings_cursor < 3) {
+                    settings_cursor++;
+                } else {
+                    settings_cursor = 0;
+                    display.NextPage();  // exits SCALE_SETTINGS → FLOCK_VIEW
                 }
             } else {
-                for (int i = num_boids; i < old_num; i++) {
-                    voices[i].SetActive(false);
-                }
+                // Cycle display page
+                display.NextPage();
             }
-#endif
-        }
+            break;
 
-        // Press: cycle display page
-        if (patch.encoder.RisingEdge()) {
-            display.NextPage();
-        }
-    }
+        case murmur::TraceEventType::GATE:
+            // GATE_2: Scatter flock (randomize positions)
+            if (event.index == 1) {
+#ifdef MURMUR_FLOCK_IN_AUDIO
+                ScopedIrqBlocker block_audio;
+#endif
+                flock.Scatter();
+            }
+            break;
 
-    // === GATE INPUTS ===
-    // GATE_1: Reserved (was buffer freeze, no longer needed)
+        case murmur::TraceEventType::CHORD:
+            chord_prog.Restore(event.index, event.value, System::GetNow(), scale_quantizer);
+            break;
 
-    // GATE_2: Scatter flock (randomize positions)
-    if (patch.gate_input[1].Trig()) {
-        flock.Scatter();
+        default:
+            break;
     }
 }
 
@@ -296,7 +651,13 @@ void UpdateDisplay() {
         }
 
         case murmur::DisplayPage::PARAMETERS:
+#ifndef MURMUR_UI_ONLY
+            display.DrawParameters(boids_params, num_boids, morph,
+                                   static_cast<int>(voices.GetNumLive()),
+                                   cpu_meter.GetAvgCpuLoad());
+#else
             display.DrawParameters(boids_params, num_boids, morph);
+#endif
             break;
 
         case murmur::DisplayPage::SCALE_SETTINGS:
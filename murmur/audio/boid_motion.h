@@ -0,0 +1,120 @@
+#pragma once
+#ifndef BOID_MOTION_H
+#define BOID_MOTION_H
+
+#include "../boids/vec3.h"
+#include "scale_quantizer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace murmur {
+
+// Longest time a snapshot is extrapolated (two of the longest adaptive steps). If the main
+// loop stalls beyond this, boids hold still instead of flying off along stale velocities.
+constexpr float MOTION_MAX_LOOKAHEAD = 0.016f;
+
+// Hand-off of flock state from the main loop to the audio callback.
+//
+// The main loop publishes each boid's position and velocity at the newest simulation step,
+// stamped with the sample-clock time that step represents. The callback extrapolates
+// pos + vel * (now - stamp) once per block, so voice targets move continuously between
+// ticks: no 2 ms staircase for the smoothing filters to hide, and none of the one-step
+// delay that GetInterpolatedPosition() adds.
+//
+// Each snapshot also carries the voice count and scale the main loop had at that step, so
+// the callback maps every boid of a block with one consistent set instead of reading
+// globals the main loop may be halfway through changing.
+//
+// Double-buffered: Publish() fills the buffer the callback is not reading, then flips
+// front_. The audio interrupt preempts the main loop but never the other way round, so
+// a block always reads one complete snapshot.
+template <size_t Capacity>
+class BoidMotion {
+public:
+    BoidMotion() : inv_sample_rate_(1.0f / 48000.0f), front_(0) {
+        for (Snapshot& snap : snapshots_) {
+            snap.num_boids  = 0;
+            snap.num_voices = 1;
+            snap.stamp      = 0;
+        }
+    }
+
+    void Init(float sample_rate) { inv_sample_rate_ = 1.0f / sample_rate; }
+
+    // Main loop, after Advance(). now is the current sample clock; the flock's newest
+    // step lags it by GetStateAge() seconds. num_voices is the active voice count (boids
+    // beyond it are not mapped) and scale the quantizer the voices are mapped through.
+    template <typename FlockT>
+    void Publish(const FlockT& flock, uint32_t now, size_t num_voices,
+                 const ScaleQuantizer& scale) {
+        Snapshot& snap = snapshots_[front_ ^ 1u];
+        size_t num = flock.GetNumBoids();
+        if (num > num_voices) num = num_voices;
+        if (num > Capacity) num = Capacity;
+
+        for (size_t i = 0; i < num; i++) {
+            const Vec3 p = flock.GetPosition(i);
+            const Vec3 v = flock.GetVelocity(i);
+            snap.pos_x[i] = p.x;
+            snap.pos_y[i] = p.y;
+            snap.pos_z[i] = p.z;
+            snap.vel_x[i] = v.x;
+            snap.vel_y[i] = v.y;
+            snap.vel_z[i] = v.z;
+        }
+        snap.num_boids  = num;
+        snap.num_voices = num_voices > 0 ? num_voices : 1;
+        snap.scale      = scale;
+        snap.stamp      = now - static_cast<uint32_t>(flock.GetStateAge() / inv_sample_rate_ + 0.5f);
+
+        // Snapshot stores must land before the flip (single core: a compiler fence suffices)
+        std::atomic_signal_fence(std::memory_order_release);
+        front_ ^= 1u;
+    }
+
+    // Audio callback: boids to map in the latest snapshot (at most its voice count)
+    size_t GetNumBoids() const { return snapshots_[front_].num_boids; }
+    // Audio callback: active voices and the scale at the latest snapshot
+    size_t GetNumVoices() const { return snapshots_[front_].num_voices; }
+    const ScaleQuantizer& GetScale() const { return snapshots_[front_].scale; }
+
+    // Audio callback: boid position at sample-clock time now, clamped to the unit cube
+    Vec3 Extrapolate(size_t index, uint32_t now) const {
+        const Snapshot& snap = snapshots_[front_];
+        // Signed difference survives clock wrap; rounding can put the stamp slightly ahead
+        const int32_t age = static_cast<int32_t>(now - snap.stamp);
+        float t = static_cast<float>(age > 0 ? age : 0) * inv_sample_rate_;
+        if (t > MOTION_MAX_LOOKAHEAD) t = MOTION_MAX_LOOKAHEAD;
+
+        Vec3 p(snap.pos_x[index] + snap.vel_x[index] * t,
+               snap.pos_y[index] + snap.vel_y[index] * t,
+               snap.pos_z[index] + snap.vel_z[index] * t);
+        p.x = p.x < 0.0f ? 0.0f : (p.x > 1.0f ? 1.0f : p.x);
+        p.y = p.y < 0.0f ? 0.0f : (p.y > 1.0f ? 1.0f : p.y);
+        p.z = p.z < 0.0f ? 0.0f : (p.z > 1.0f ? 1.0f : p.z);
+        return p;
+    }
+
+private:
+    struct Snapshot {
+        float pos_x[Capacity];
+        float pos_y[Capacity];
+        float pos_z[Capacity];
+        float vel_x[Capacity];
+        float vel_y[Capacity];
+        float vel_z[Capacity];
+        size_t   num_boids;
+        size_t   num_voices;
+        ScaleQuantizer scale;
+        uint32_t stamp;  // sample clock at the step
+    };
+
+    float inv_sample_rate_;
+    Snapshot snapshots_[2];
+    volatile uint32_t front_;  // buffer the callback reads
+};
+
+} // namespace murmur
+
+#endif // BOID_MOTION_H
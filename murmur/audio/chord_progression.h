@@ -40,6 +40,15 @@ public:
         }
     }
 
+    // Trace replay and snapshot restore: jumps straight to a recorded / saved mode and
+    // chord (timer restarts at now).
+    void Restore(int mode, int index, uint32_t now, ScaleQuantizer& sq) {
+        mode_  = ((mode % 3) + 3) % 3;
+        index_ = ((index % 4) + 4) % 4;
+        last_change_ms_ = now;
+        sq.SetChordOffset(mode_ == 0 ? 0 : Offset(index_));
+    }
+
     // Builds the flock-view label (e.g. "IV:D#") into buf.
     // Returns true and fills buf when the progression is active and scale != OFF.
     // Returns false when inactive — caller should treat label as nullptr.
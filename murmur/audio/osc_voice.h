@@ -7,6 +7,8 @@
 
 namespace murmur {
 
+// One voice rendered a sample at a time from naive waveforms. The firmware renders through
+// VoiceBank (a block at a time, band-limited wavetables); host/voice_bench compares the two.
 struct OscVoice {
     daisysp::Svf filter;
 
@@ -77,17 +79,19 @@ struct OscVoice {
         morph_ = morph < 0.0f ? 0.0f : (morph > 2.0f ? 2.0f : morph);
     }
 
-    // Call once per boid tick (500 Hz) to smooth parameters and update DSP state.
-    void UpdateSmoothing() {
+    // Smooths parameters toward their targets and updates DSP state. The coefficients are
+    // per 2 ms tick; ticks scales them for other call intervals (e.g. once per audio block:
+    // block_size / (0.002 * sample_rate)), keeping the same time constants.
+    void UpdateSmoothing(float ticks = 1.0f) {
         constexpr float coeff_freq = 0.006f;
         constexpr float coeff_amp  = 0.05f;
         constexpr float coeff_pan  = 0.006f;
         constexpr float coeff_z    = 0.05f;
 
-        current_freq += (target_freq - current_freq) * coeff_freq;
-        current_amp  += (target_amp  - current_amp)  * coeff_amp;
-        current_pan  += (target_pan  - current_pan)  * coeff_pan;
-        current_z    += (target_z    - current_z)    * coeff_z;
+        current_freq += (target_freq - current_freq) * (coeff_freq * ticks);
+        current_amp  += (target_amp  - current_amp)  * (coeff_amp  * ticks);
+        current_pan  += (target_pan  - current_pan)  * (coeff_pan  * ticks);
+        current_z    += (target_z    - current_z)    * (coeff_z    * ticks);
 
         phase_inc_ = current_freq / sample_rate_;
 
@@ -0,0 +1,100 @@
+#pragma once
+#ifndef SVF_BANK_H
+#define SVF_BANK_H
+
+#include <cmath>
+#include <cstddef>
+
+namespace murmur {
+
+// Cutoff steps in SvfBank's coefficient table, evenly spaced from 0 Hz to the highest
+// cutoff (sample_rate / 3, as in DaisySP's Svf).
+constexpr size_t SVF_TABLE_SIZE = 256;
+
+// Low-pass state-variable filters for a bank of voices, one array per field.
+//
+// Same filter as DaisySP's Svf (double-sampled Chamberlin, output the mean of both
+// low-pass taps, no drive), but a cutoff change is a table lookup instead of Svf::SetFreq's
+// sinf and powf, and the filters run in lockstep: the caller loads a few voices' filters
+// into Lane locals, runs them side by side through a block and stores them back.
+template <size_t Capacity>
+class SvfBank {
+public:
+    // One filter's coefficients and state while a block is rendered
+    struct Lane {
+        float f;     // 2 sin(π fc / 2fs)
+        float damp;
+        float low;
+        float band;
+
+        float Process(float in) {
+            float out = 0.0f;
+            for (int pass = 0; pass < 2; pass++) {
+                low += f * band;
+                const float high = in - damp * band - low;
+                band += f * high;
+                out += 0.5f * low;
+            }
+            return out;
+        }
+    };
+
+    // res: 0-1, as Svf::SetRes()
+    void Init(float sample_rate, float res) {
+        const float max_cutoff = sample_rate / 3.0f;
+        const float res_damp   = 2.0f * (1.0f - powf(res, 0.25f));
+        hz_to_index_ = static_cast<float>(SVF_TABLE_SIZE) / max_cutoff;
+
+        for (size_t i = 0; i <= SVF_TABLE_SIZE; i++) {
+            float hz = max_cutoff * static_cast<float>(i) / static_cast<float>(SVF_TABLE_SIZE);
+            if (hz < 1.0e-6f) hz = 1.0e-6f;
+            const float f = 2.0f * sinf(3.14159265f * fminf(0.25f, hz / (sample_rate * 2.0f)));
+            table_f_[i]    = f;
+            table_damp_[i] = fminf(res_damp, fminf(2.0f, 2.0f / f - f * 0.5f));
+        }
+        table_f_[SVF_TABLE_SIZE + 1]    = table_f_[SVF_TABLE_SIZE];
+        table_damp_[SVF_TABLE_SIZE + 1] = table_damp_[SVF_TABLE_SIZE];
+
+        for (size_t v = 0; v < Capacity; v++) {
+            Reset(v);
+            SetCutoff(v, 200.0f);
+        }
+    }
+
+    // Cutoffs are clamped to 0 - sample_rate / 3
+    void SetCutoff(size_t v, float hz) {
+        float pos = hz * hz_to_index_;
+        if (pos < 0.0f) pos = 0.0f;
+        if (pos > static_cast<float>(SVF_TABLE_SIZE)) pos = static_cast<float>(SVF_TABLE_SIZE);
+        const size_t i    = static_cast<size_t>(pos);
+        const float  frac = pos - static_cast<float>(i);
+        freq_[v] = table_f_[i]    + (table_f_[i + 1]    - table_f_[i])    * frac;
+        damp_[v] = table_damp_[i] + (table_damp_[i + 1] - table_damp_[i]) * frac;
+    }
+
+    // Clears filter v's state (the coefficients stay)
+    void Reset(size_t v) {
+        low_[v]  = 0.0f;
+        band_[v] = 0.0f;
+    }
+
+    Lane Load(size_t v) const { return Lane{freq_[v], damp_[v], low_[v], band_[v]}; }
+    void Store(size_t v, const Lane& lane) {
+        low_[v]  = lane.low;
+        band_[v] = lane.band;
+    }
+
+private:
+    float hz_to_index_;
+    float table_f_[SVF_TABLE_SIZE + 2];  // + guard, so the top entry interpolates
+    float table_damp_[SVF_TABLE_SIZE + 2];
+
+    float freq_[Capacity];
+    float damp_[Capacity];
+    float low_[Capacity];
+    float band_[Capacity];
+};
+
+} // namespace murmur
+
+#endif // SVF_BANK_H
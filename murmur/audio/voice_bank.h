@@ -0,0 +1,322 @@
+#pragma once
+#ifndef VOICE_BANK_H
+#define VOICE_BANK_H
+
+#include "svf_bank.h"
+#include "wavetable.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace murmur {
+
+// Longest block ProcessBlock() renders in one pass; callers split longer blocks.
+constexpr size_t VOICE_MAX_BLOCK = 256;
+
+// Voices rendered side by side in ProcessBlock(): enough independent filter chains to
+// hide FPU latency while every lane's state still fits in registers.
+constexpr size_t VOICE_LANES = 4;
+
+// Released voices stop rendering once their level falls below this (-80 dB)
+constexpr float VOICE_SILENCE_AMP = 0.0001f;
+
+// Fixed bank of oscillator voices, one per boid. Capacity is a compile-time constant
+// so each build allocates exactly the voices it can play (see MURMUR_MAX_BOIDS).
+//
+// Sounds like OscVoice (sine/triangle/square morph, low-pass state variable filter,
+// linear pan), but renders a whole block per call from one array per field: audible
+// voices are gathered once per block, then rendered VOICE_LANES at a time with their
+// phase, filter and gains held in registers for the whole block. The filters (resonance
+// 0.1) are an SvfBank, run in the same lockstep.
+//
+// The oscillator reads band-limited MorphWavetable tables with a 32-bit integer phase
+// accumulator (wraps for free) and linear interpolation, using the octave level that
+// keeps the voice's harmonics below Nyquist. No libm call runs per sample.
+//
+// UpdateSmoothing() runs once per block and sets where each voice should be at the end of
+// the next block; ProcessBlock() ramps the pitch and the left, right and reverb gains
+// there linearly, sample by sample, so control updates never step audibly. The filter
+// coefficients change once per block, between ramps.
+//
+// Only live voices render: a compact list of the active voices plus the released ones
+// still fading out. UpdateReleased() fades the released voices at control rate and drops
+// each from the list once it is silent, so ProcessBlock() loops over live voices only,
+// with no per-voice or per-sample silence checks.
+template <size_t Capacity>
+class VoiceBank {
+public:
+    static constexpr size_t kCapacity = Capacity;
+
+    // tables must be initialized and outlive the bank
+    void Init(float sample_rate, const MorphWavetable& tables) {
+        tables_      = &tables;
+        sample_rate_ = sample_rate;
+        filters_.Init(sample_rate, 0.1f);
+        for (size_t v = 0; v < Capacity; v++) {
+            phase_[v]         = 0;
+            phase_inc_[v]     = PhaseIncrement(440.0f);
+            end_phase_inc_[v] = phase_inc_[v];
+            level_[v]         = tables.Level(phase_inc_[v]);
+            morph_[v]     = 1.0f;  // default: triangle
+
+            gain_l_[v]          = 0.0f;
+            gain_r_[v]          = 0.0f;
+            reverb_send_[v]     = 0.0f;
+            end_gain_l_[v]      = 0.0f;
+            end_gain_r_[v]      = 0.0f;
+            end_reverb_send_[v] = 0.0f;
+            target_freq_[v]  = 440.0f;
+            target_amp_[v]   = 0.0f;
+            target_pan_[v]   = 0.0f;
+            target_z_[v]     = 0.5f;
+            current_freq_[v] = 440.0f;
+            current_amp_[v]  = 0.0f;
+            current_pan_[v]  = 0.0f;
+            current_z_[v]    = 0.5f;
+            active_[v]       = false;
+            listed_[v]       = false;
+        }
+        num_live_ = 0;
+    }
+
+    void SetParams(size_t v, float freq, float amp, float pan, float z) {
+        target_freq_[v] = freq;
+        target_amp_[v]  = amp;
+        target_pan_[v]  = pan;
+        target_z_[v]    = z;
+    }
+
+    // Bypass freq smoothing: jump immediately to target (for scale-quantized mode).
+    void SnapFreq(size_t v, float freq) {
+        target_freq_[v]  = freq;
+        current_freq_[v] = freq;
+    }
+
+    // morph: 0=sine, 1=triangle, 2=square. Continuous blend between adjacent shapes.
+    void SetMorph(size_t v, float morph) {
+        morph_[v] = morph < 0.0f ? 0.0f : (morph > 2.0f ? 2.0f : morph);
+    }
+
+    // Activates voices [from, to) or releases them (they fade out via UpdateReleased()).
+    // Edits the live list: not while ProcessBlock() or UpdateReleased() may run.
+    void SetActive(size_t from, size_t to, bool active) {
+        if (to > Capacity) to = Capacity;
+        for (size_t v = from; v < to; v++) {
+            active_[v] = active;
+            if (!active) {
+                target_amp_[v] = 0.0f;
+            } else if (!listed_[v]) {
+                listed_[v]         = true;
+                live_[num_live_++] = v;
+            }
+        }
+    }
+
+    bool IsActive(size_t v) const { return active_[v]; }
+    // Voices rendered by ProcessBlock(): active plus still fading out
+    size_t GetNumLive() const { return num_live_; }
+
+    // Smooths voice v's parameters toward their targets, updates its filter and sets the
+    // pitch and gains the next block ramps to. Same coefficients and ticks scaling as
+    // OscVoice::UpdateSmoothing().
+    void UpdateSmoothing(size_t v, float ticks = 1.0f) {
+        constexpr float coeff_freq = 0.006f;
+        constexpr float coeff_amp  = 0.05f;
+        constexpr float coeff_pan  = 0.006f;
+        constexpr float coeff_z    = 0.05f;
+
+        current_freq_[v] += (target_freq_[v] - current_freq_[v]) * (coeff_freq * ticks);
+        current_amp_[v]  += (target_amp_[v]  - current_amp_[v])  * (coeff_amp  * ticks);
+        current_pan_[v]  += (target_pan_[v]  - current_pan_[v])  * (coeff_pan  * ticks);
+        current_z_[v]    += (target_z_[v]    - current_z_[v])    * (coeff_z    * ticks);
+
+        // Tables for the higher end of the pitch ramp, so neither end aliases
+        end_phase_inc_[v] = PhaseIncrement(current_freq_[v]);
+        level_[v] = tables_->Level(end_phase_inc_[v] > phase_inc_[v] ? end_phase_inc_[v]
+                                                                     : phase_inc_[v]);
+
+        // LPF cutoff: 2x fundamental at z=0 up to 7 kHz+ at z=1 (see OscVoice)
+        filters_.SetCutoff(v, current_freq_[v] * 2.0f + current_z_[v] * 7000.0f);
+
+        float pan_norm = (current_pan_[v] + 1.0f) * 0.5f;
+        end_gain_l_[v]      = (1.0f - pan_norm) * current_amp_[v];
+        end_gain_r_[v]      = pan_norm          * current_amp_[v];
+        end_reverb_send_[v] = current_amp_[v];
+    }
+
+    // Control rate, once per block alongside the active voices' UpdateSmoothing():
+    // smooths the released voices toward silence and drops those that got there.
+    void UpdateReleased(float ticks = 1.0f) {
+        size_t kept = 0;
+        for (size_t n = 0; n < num_live_; n++) {
+            const size_t v = live_[n];
+            if (!active_[v]) {
+                UpdateSmoothing(v, ticks);
+                if (current_amp_[v] < VOICE_SILENCE_AMP) {
+                    // Silent: start clean if it is activated again
+                    listed_[v]      = false;
+                    current_amp_[v] = 0.0f;
+                    end_gain_l_[v] = end_gain_r_[v] = end_reverb_send_[v] = 0.0f;
+                    EndRamp(v);
+                    filters_.Reset(v);
+                    continue;
+                }
+            }
+            live_[kept++] = v;
+        }
+        num_live_ = kept;
+    }
+
+    // Renders the live voices for size samples (at most VOICE_MAX_BLOCK), adding their
+    // output into the left, right and reverb-send buses.
+    void ProcessBlock(float* out_l, float* out_r, float* rev, size_t size) {
+        if (size > VOICE_MAX_BLOCK) size = VOICE_MAX_BLOCK;
+
+        size_t g = 0;
+        for (; g + VOICE_LANES <= num_live_; g += VOICE_LANES) {
+            RenderLanes<VOICE_LANES>(live_ + g, out_l, out_r, rev, size);
+        }
+        switch (num_live_ - g) {
+            case 3: RenderLanes<3>(live_ + g, out_l, out_r, rev, size); break;
+            case 2: RenderLanes<2>(live_ + g, out_l, out_r, rev, size); break;
+            case 1: RenderLanes<1>(live_ + g, out_l, out_r, rev, size); break;
+            default: break;
+        }
+    }
+
+private:
+    void EndRamp(size_t v) {
+        phase_inc_[v]   = end_phase_inc_[v];
+        gain_l_[v]      = end_gain_l_[v];
+        gain_r_[v]      = end_gain_r_[v];
+        reverb_send_[v] = end_reverb_send_[v];
+    }
+
+    // Cycles per sample * 2^32, kept below Nyquist
+    uint32_t PhaseIncrement(float hz) const {
+        float cycles = hz / sample_rate_;
+        if (cycles < 0.0f) cycles = 0.0f;
+        if (cycles > 0.5f) cycles = 0.5f;
+        return static_cast<uint32_t>(cycles * 4294967296.0f);
+    }
+
+    template <size_t Lanes>
+    void RenderLanes(const size_t* idx, float* out_l, float* out_r, float* rev, size_t size) {
+        uint32_t     phase[Lanes], inc[Lanes];
+        int32_t      inc_step[Lanes];
+        const float* table_a[Lanes];
+        const float* table_b[Lanes];
+        float        blend[Lanes];
+        typename SvfBank<Capacity>::Lane filter[Lanes];
+        float        gl[Lanes], gr[Lanes], send[Lanes];
+        float        gl_step[Lanes], gr_step[Lanes], send_step[Lanes];
+        const float  inv_size = 1.0f / static_cast<float>(size);
+        for (size_t k = 0; k < Lanes; k++) {
+            const size_t v = idx[k];
+            // Morph: 0-1 blends sine→triangle, 1-2 blends triangle→square
+            const float m = morph_[v];
+            if (m <= 1.0f) {
+                table_a[k] = tables_->Table(WaveShape::SINE, level_[v]);
+                table_b[k] = tables_->Table(WaveShape::TRIANGLE, level_[v]);
+                blend[k]   = m;
+            } else {
+                table_a[k] = tables_->Table(WaveShape::TRIANGLE, level_[v]);
+                table_b[k] = tables_->Table(WaveShape::SQUARE, level_[v]);
+                blend[k]   = m - 1.0f;
+            }
+
+            phase[k]  = phase_[v];
+            filter[k] = filters_.Load(v);
+
+            // Ramps from the last block's end to this block's end
+            inc[k]       = phase_inc_[v];
+            inc_step[k]  = static_cast<int32_t>(end_phase_inc_[v] - inc[k])
+                         / static_cast<int32_t>(size);
+            gl[k]        = gain_l_[v];
+            gr[k]        = gain_r_[v];
+            send[k]      = reverb_send_[v];
+            gl_step[k]   = (end_gain_l_[v] - gl[k]) * inv_size;
+            gr_step[k]   = (end_gain_r_[v] - gr[k]) * inv_size;
+            send_step[k] = (end_reverb_send_[v] - send[k]) * inv_size;
+        }
+
+        for (size_t i = 0; i < size; i++) {
+            float sum_l = 0.0f, sum_r = 0.0f, sum_rev = 0.0f;
+            for (size_t k = 0; k < Lanes; k++) {
+                inc[k]   += static_cast<uint32_t>(inc_step[k]);
+                phase[k] += inc[k];
+                gl[k]    += gl_step[k];
+                gr[k]    += gr_step[k];
+                send[k]  += send_step[k];
+
+                // Both tables at the same interpolated position
+                const uint32_t index = phase[k] >> WAVETABLE_FRAC_BITS;
+                const float    frac  = static_cast<float>(phase[k] & ((1u << WAVETABLE_FRAC_BITS) - 1))
+                                     * (1.0f / static_cast<float>(1u << WAVETABLE_FRAC_BITS));
+                const float a0 = table_a[k][index], a1 = table_a[k][index + 1];
+                const float b0 = table_b[k][index], b1 = table_b[k][index + 1];
+                const float a  = a0 + (a1 - a0) * frac;
+                const float b  = b0 + (b1 - b0) * frac;
+                const float raw = a + (b - a) * blend[k];
+
+                const float s = filter[k].Process(raw);
+
+                sum_l   += s * gl[k];
+                sum_r   += s * gr[k];
+                sum_rev += s * send[k];
+            }
+            out_l[i] += sum_l;
+            out_r[i] += sum_r;
+            rev[i]   += sum_rev;
+        }
+
+        for (size_t k = 0; k < Lanes; k++) {
+            phase_[idx[k]] = phase[k];
+            filters_.Store(idx[k], filter[k]);
+            EndRamp(idx[k]);  // exact end values, free of step rounding
+        }
+    }
+
+    const MorphWavetable* tables_;
+    float sample_rate_;
+
+    // Oscillator
+    uint32_t phase_[Capacity];          // 0-2^32 phase accumulator
+    uint32_t phase_inc_[Capacity];      // frequency / sample_rate * 2^32, at the block start
+    uint32_t end_phase_inc_[Capacity];  // ... and at the end of the next block
+    size_t   level_[Capacity];          // wavetable octave level for the ramp
+    float    morph_[Capacity];
+
+    // Low-pass filters, cutoff from the smoothed freq and z
+    SvfBank<Capacity> filters_;
+
+    // Output gains, from the smoothed amp and pan: at the block start, and at the end of
+    // the next block
+    float gain_l_[Capacity];
+    float gain_r_[Capacity];
+    float reverb_send_[Capacity];
+    float end_gain_l_[Capacity];
+    float end_gain_r_[Capacity];
+    float end_reverb_send_[Capacity];
+
+    // Parameter smoothing
+    float target_freq_[Capacity];
+    float target_amp_[Capacity];
+    float target_pan_[Capacity];
+    float target_z_[Capacity];
+    float current_freq_[Capacity];
+    float current_amp_[Capacity];
+    float current_pan_[Capacity];
+    float current_z_[Capacity];
+
+    bool active_[Capacity];
+
+    // Live list: voice indices, and whether each voice is on it
+    size_t live_[Capacity];
+    bool   listed_[Capacity];
+    size_t num_live_;
+};
+
+} // namespace murmur
+
+#endif // VOICE_BANK_H
@@ -0,0 +1,51 @@
+#include "wavetable.h"
+#include <cmath>
+
+namespace murmur {
+
+void MorphWavetable::Init() {
+    constexpr size_t mask = WAVETABLE_SIZE - 1;
+    constexpr float  pi   = 3.14159265358979f;
+
+    for (size_t i = 0; i < WAVETABLE_SIZE; i++) {
+        sine_[i] = sinf(2.0f * pi * static_cast<float>(i) / static_cast<float>(WAVETABLE_SIZE));
+    }
+    sine_[WAVETABLE_SIZE] = sine_[0];
+
+    // Built from the top level (fewest harmonics) down: each level starts as a copy of the
+    // one above and adds the odd harmonics it lacks. sin(2π·n·i/N) is sine_[n·i mod N], so
+    // no harmonic needs a libm call.
+    //   triangle: -8/π² Σ cos(nθ)/n²   (OscVoice: 1 - 4|phase - 0.5|)
+    //   square:    4/π  Σ sin(nθ)/n    (OscVoice: +1 for phase < 0.5, -1 after)
+    size_t done = 0;  // highest harmonic summed so far
+    for (size_t level = WAVETABLE_LEVELS; level-- > 0;) {
+        float* tri    = tri_[level];
+        float* square = square_[level];
+        for (size_t i = 0; i < WAVETABLE_SIZE; i++) {
+            tri[i]    = level + 1 < WAVETABLE_LEVELS ? tri_[level + 1][i]    : 0.0f;
+            square[i] = level + 1 < WAVETABLE_LEVELS ? square_[level + 1][i] : 0.0f;
+        }
+
+        const size_t harmonics = WAVETABLE_BASE_HARMONICS >> level;
+        for (size_t n = done + 1; n <= harmonics; n++) {
+            if (n % 2 == 0) continue;
+            const float nf     = static_cast<float>(n);
+            const float tri_a  = -8.0f / (pi * pi * nf * nf);
+            const float sq_a   = 4.0f / (pi * nf);
+            const size_t cos_offset = WAVETABLE_SIZE / 4;  // cos θ = sin(θ + π/2)
+            for (size_t i = 0; i < WAVETABLE_SIZE; i++) {
+                const size_t k = (n * i) & mask;
+                tri[i]    += tri_a * sine_[(k + cos_offset) & mask];
+                square[i] += sq_a  * sine_[k];
+            }
+        }
+        if (harmonics > done) done = harmonics;
+        tri[WAVETABLE_SIZE]    = tri[0];
+        square[WAVETABLE_SIZE] = square[0];
+
+        // Highest harmonic at Nyquist: phase_inc * harmonics <= 2^31
+        level_inc_[level] = static_cast<uint32_t>(2147483648.0 / static_cast<double>(harmonics));
+    }
+}
+
+} // namespace murmur
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef WAVETABLE_H
+#define WAVETABLE_H
+
+#include <cstdint>
+#include <cstddef>
+
+namespace murmur {
+
+// Single-cycle table length (power of two) and the fractional phase bits below the index
+// of a 32-bit phase accumulator.
+constexpr size_t   WAVETABLE_SIZE      = 1024;
+constexpr uint32_t WAVETABLE_FRAC_BITS = 22;  // 32 - log2(WAVETABLE_SIZE)
+
+// Octave mipmap levels. Level k holds the harmonics up to WAVETABLE_BASE_HARMONICS >> k,
+// and plays every frequency whose highest harmonic then stays below Nyquist
+// (80 Hz and below at level 0 up to 20 kHz at level 8, at 48 kHz).
+constexpr size_t WAVETABLE_LEVELS          = 9;
+constexpr size_t WAVETABLE_BASE_HARMONICS  = 300;
+
+enum class WaveShape : uint8_t { SINE, TRIANGLE, SQUARE };
+
+// Band-limited tables for the sine → triangle → square morph (CTRL_4), built once at
+// Init() by additive synthesis. The waveforms match OscVoice's naive ones in phase and
+// level, minus the harmonics that would fold back above Nyquist. Sine has one table;
+// triangle and square have one per octave level. Each table carries one guard sample
+// (a copy of sample 0) so interpolated reads never wrap.
+//
+// Memory: ~78 KB of SRAM.
+class MorphWavetable {
+public:
+    void Init();
+
+    // Level for a 32-bit phase increment (cycles per sample * 2^32)
+    size_t Level(uint32_t phase_inc) const {
+        size_t level = 0;
+        while (level + 1 < WAVETABLE_LEVELS && phase_inc > level_inc_[level]) level++;
+        return level;
+    }
+
+    const float* Table(WaveShape shape, size_t level) const {
+        switch (shape) {
+            case WaveShape::TRIANGLE: return tri_[level];
+            case WaveShape::SQUARE:   return square_[level];
+            default:                  return sine_;
+        }
+    }
+
+private:
+    uint32_t level_inc_[WAVETABLE_LEVELS];  // highest phase increment each level plays
+    float sine_[WAVETABLE_SIZE + 1];
+    float tri_[WAVETABLE_LEVELS][WAVETABLE_SIZE + 1];
+    float square_[WAVETABLE_LEVELS][WAVETABLE_SIZE + 1];
+};
+
+} // namespace murmur
+
+#endif // WAVETABLE_H
@@ -1,130 +1,544 @@
 #include "boids.h"
+#include "flock_kernel.h"
 #include <cmath>
 
 namespace murmur {
 
-float BoidsFlock::Random01() {
-    // Linear congruential generator
-    rng_state_ = rng_state_ * 1103515245 + 12345;
-    return static_cast<float>((rng_state_ >> 16) & 0x7FFF) / 32767.0f;
+template <size_t Capacity>
+float BoidsFlock<Capacity>::Random01() {
+    return FlockKernel::Random01(*this);
 }
 
-void BoidsFlock::Init(size_t num_boids) {
+template <size_t Capacity>
+void BoidsFlock<Capacity>::InitBoid(size_t i) {
+    FlockKernel::SpawnBoid(*this, i);
+    lod_elapsed_[i]  = 0.0f;
+    lod_isolated_[i] = 0;
+    lod_defer_[i]    = 0;
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SnapPrevious(size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) {
+        prev_pos_x_[i] = pos_x_[i];
+        prev_pos_y_[i] = pos_y_[i];
+        prev_pos_z_[i] = pos_z_[i];
+    }
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::ParkPadding() {
+    FlockKernel::ParkLanes(*this, num_boids_, kPadded);
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::Init(size_t num_boids) {
     rng_state_ = 12345;  // Seed
 
-    num_boids_ = (num_boids > MAX_BOIDS) ? MAX_BOIDS : num_boids;
+    num_boids_ = (num_boids > Capacity) ? Capacity : num_boids;
 
-    // Initialize boids with random positions inside safe zone (within margins)
     for (size_t i = 0; i < num_boids_; i++) {
-        boids_[i].position = Vec3(
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            0.3f + Random01() * 0.4f  // z starts in 0.3-0.7 range (within margins)
-        );
-        boids_[i].velocity = Vec3(
-            (Random01() - 0.5f) * 0.02f,
-            (Random01() - 0.5f) * 0.02f,
-            (Random01() - 0.5f) * 0.01f  // Slower z movement
-        );
-        boids_[i].acceleration = Vec3(0.0f, 0.0f, 0.0f);
-        boids_[i].wander_angle = Random01() * 6.2832f;  // random start angle 0-2pi
+        InitBoid(i);
     }
+    ParkPadding();
+    SnapPrevious(0, kPadded);
+    verlet_valid_ = false;
+    verlet_backoff_ = 0;
+    accumulator_  = 0.0f;
+    alpha_        = 0.0f;
+    saved_us_     = 0;
+    mean_neighbors_ = 0.0f;
+    state_version_++;
 
     initialized_ = true;
 }
 
-void BoidsFlock::SetNumBoids(size_t num) {
-    size_t new_num = (num > MAX_BOIDS) ? MAX_BOIDS : num;
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SetNumBoids(size_t num) {
+    size_t new_num = (num > Capacity) ? Capacity : num;
 
     // Initialize any new boids inside safe zone
     for (size_t i = num_boids_; i < new_num; i++) {
-        boids_[i].position = Vec3(
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            0.3f + Random01() * 0.4f
-        );
-        boids_[i].velocity = Vec3(
-            (Random01() - 0.5f) * 0.02f,
-            (Random01() - 0.5f) * 0.02f,
-            (Random01() - 0.5f) * 0.01f
-        );
-        boids_[i].acceleration = Vec3(0.0f, 0.0f, 0.0f);
-        boids_[i].wander_angle = Random01() * 6.2832f;
+        InitBoid(i);
     }
 
+    size_t old_num = num_boids_;
     num_boids_ = new_num;
+    ParkPadding();
+    if (new_num > old_num) SnapPrevious(old_num, new_num);
+    verlet_valid_ = false;
+    verlet_backoff_ = 0;
+    state_version_++;
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SetBoidState(size_t index, const Vec3& pos, const Vec3& vel) {
+    if (index >= num_boids_) return;
+    pos_x_[index] = pos.x;
+    pos_y_[index] = pos.y;
+    pos_z_[index] = pos.z;
+    vel_x_[index] = vel.x;
+    vel_y_[index] = vel.y;
+    vel_z_[index] = vel.z;
+    SnapPrevious(index, index + 1);
+    verlet_valid_ = false;
+    state_version_++;
 }
 
-void BoidsFlock::Scatter() {
+template <size_t Capacity>
+void BoidsFlock<Capacity>::Scatter() {
     for (size_t i = 0; i < num_boids_; i++) {
-        boids_[i].position = Vec3(
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY),
-            BOUNDARY_MARGIN_Z_LO + Random01() * (1.0f - BOUNDARY_MARGIN_Z_LO - BOUNDARY_MARGIN_Z_HI)
-        );
-        boids_[i].velocity = Vec3(
-            (Random01() - 0.5f) * 0.05f,
-            (Random01() - 0.5f) * 0.05f,
-            (Random01() - 0.5f) * 0.02f
-        );
-    }
-}
-
-Vec3 BoidsFlock::ApplyFlockingForces(size_t boid_idx, const BoidsParams& params) {
-    const Vec3& pos = boids_[boid_idx].position;
-    const Vec3& vel = boids_[boid_idx].velocity;
-    float radius_sq = params.perception_radius * params.perception_radius;
+        pos_x_[i] = BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        pos_y_[i] = BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        pos_z_[i] = BOUNDARY_MARGIN_Z_LO
+                  + Random01() * (1.0f - BOUNDARY_MARGIN_Z_LO - BOUNDARY_MARGIN_Z_HI);
+        vel_x_[i] = (Random01() - 0.5f) * 0.05f;
+        vel_y_[i] = (Random01() - 0.5f) * 0.05f;
+        vel_z_[i] = (Random01() - 0.5f) * 0.02f;
+    }
+    SnapPrevious(0, num_boids_);
+    verlet_valid_ = false;
+    verlet_backoff_ = 0;
+    state_version_++;
+}
 
-    // Accumulators for the three forces
-    Vec3 sep_sum(0.0f, 0.0f, 0.0f);
-    Vec3 ali_sum(0.0f, 0.0f, 0.0f);
-    Vec3 coh_sum(0.0f, 0.0f, 0.0f);
-    size_t count = 0;
+template <size_t Capacity>
+Boid BoidsFlock<Capacity>::GetBoid(size_t index) const {
+    Boid boid;
+    boid.position     = GetPosition(index);
+    boid.velocity     = GetVelocity(index);
+    boid.acceleration = Vec3(acc_x_[index], acc_y_[index], acc_z_[index]);
+    boid.wander_angle = atan2f(wander_y_[index], wander_x_[index]);
+    return boid;
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumAllNeighbors(float radius_sq) {
+    const size_t padded = PaddedCount();
+    FlockKernel::ClearNeighborSums(*this, 0, padded);
+    stats_.pair_tests += static_cast<uint32_t>(num_boids_ * padded);
+    FlockKernel::SumAllPairs(*this, 0, num_boids_, padded, radius_sq);
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumPairwiseNeighbors(float radius_sq) {
+    FlockKernel::ClearNeighborSums(*this, 0, num_boids_);
+
+    stats_.pair_tests += static_cast<uint32_t>(num_boids_ * (num_boids_ - 1) / 2);
+    FlockKernel::SumSymmetricPairs(*this, num_boids_, radius_sq,
+                                   FlockKernel::LaterBoids{num_boids_});
+}
 
-    // Single brute-force pass over all other boids
+template <size_t Capacity>
+bool BoidsFlock<Capacity>::VerletListStale(float cutoff, float skin) const {
+    if (!verlet_valid_ || cutoff != verlet_cutoff_) return true;
+
+    // Largest squared drift of any boid since the last build
+    float max_drift_sq = 0.0f;
     for (size_t i = 0; i < num_boids_; i++) {
-        if (i == boid_idx) continue;
+        float dx = pos_x_[i] - ref_pos_x_[i];
+        float dy = pos_y_[i] - ref_pos_y_[i];
+        float dz = pos_z_[i] - ref_pos_z_[i];
+        float drift_sq = dx * dx + dy * dy + dz * dz;
+        if (drift_sq > max_drift_sq) max_drift_sq = drift_sq;
+    }
+    float half_skin = 0.5f * skin;
+    return max_drift_sq > half_skin * half_skin;
+}
 
-        float dist_sq = Vec3::DistanceSquared(pos, boids_[i].position);
-        if (dist_sq >= radius_sq || dist_sq < 0.00000001f) continue;
+template <size_t Capacity>
+bool BoidsFlock<Capacity>::BuildVerletList(float cutoff) {
+    const float cutoff_sq = cutoff * cutoff;
+    size_t num_pairs = 0;
 
-        count++;
+    stats_.verlet_rebuilds++;
+    stats_.pair_tests += static_cast<uint32_t>(num_boids_ * (num_boids_ - 1) / 2);
 
-        // Separation: accumulate diff weighted by inverse squared distance
-        Vec3 diff = pos - boids_[i].position;
-        sep_sum += diff * (1.0f / dist_sq);
+    for (size_t i = 0; i < num_boids_; i++) {
+        verlet_start_[i] = static_cast<uint16_t>(num_pairs);
+        ref_pos_x_[i] = pos_x_[i];
+        ref_pos_y_[i] = pos_y_[i];
+        ref_pos_z_[i] = pos_z_[i];
+
+        for (size_t j = i + 1; j < num_boids_; j++) {
+            float dist_sq = Vec3::DistanceSquared(GetPosition(i), GetPosition(j));
+            if (dist_sq >= cutoff_sq) continue;
+            if (num_pairs >= kVerletPairs) {
+                verlet_valid_  = false;
+                verlet_cutoff_ = cutoff;
+                return false;
+            }
+            verlet_pairs_[num_pairs++] = static_cast<uint16_t>(j);
+        }
+    }
+    verlet_start_[num_boids_] = static_cast<uint16_t>(num_pairs);
+
+    verlet_cutoff_ = cutoff;
+    verlet_valid_  = true;
+    return true;
+}
+
+template <size_t Capacity>
+bool BoidsFlock<Capacity>::SumVerletNeighbors(const BoidsParams& params) {
+    const float radius_sq = params.perception_radius * params.perception_radius;
+    const float skin      = (params.verlet_skin > 0.0f) ? params.verlet_skin : 0.0f;
+    const float cutoff    = params.perception_radius + skin;
+    const uint32_t full_scan = static_cast<uint32_t>(num_boids_ * (num_boids_ - 1) / 2);
+
+    // The last build at this cutoff overflowed: stay on PAIRWISE for a while rather than
+    // paying a failed build on every tick
+    if (verlet_backoff_ > 0 && !verlet_valid_ && cutoff == verlet_cutoff_) {
+        verlet_backoff_--;
+        stats_.verlet_overflows++;
+        SumPairwiseNeighbors(radius_sq);
+        return false;
+    }
+
+    bool rebuilt = false;
+    if (VerletListStale(cutoff, skin)) {
+        rebuilt = true;
+        if (!BuildVerletList(cutoff)) {
+            stats_.verlet_overflows++;
+            verlet_backoff_ = VERLET_OVERFLOW_BACKOFF;
+            SumPairwiseNeighbors(radius_sq);
+            return false;
+        }
+    } else {
+        stats_.verlet_cached_ticks++;
+    }
+
+    const uint32_t list_len = verlet_start_[num_boids_];
+    stats_.pair_tests += list_len;
+    if (!rebuilt && list_len < full_scan) {
+        stats_.pair_tests_saved += full_scan - list_len;
+    }
+
+    FlockKernel::ClearNeighborSums(*this, 0, num_boids_);
+    FlockKernel::SumSymmetricPairs(*this, num_boids_, radius_sq,
+                                   FlockKernel::PairList{verlet_start_, verlet_pairs_});
+    return !rebuilt;
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumNearestNeighbors(size_t k) {
+    if (k < 1) k = 1;
+    if (k > TOPOLOGICAL_MAX_K) k = TOPOLOGICAL_MAX_K;
+
+    stats_.pair_tests += static_cast<uint32_t>(num_boids_ * (num_boids_ - 1));
 
-        // Alignment: accumulate neighbor velocities
-        ali_sum += boids_[i].velocity;
+    for (size_t i = 0; i < num_boids_; i++) {
+        if (lod_defer_[i]) continue;
+        const float px = pos_x_[i];
+        const float py = pos_y_[i];
+        const float pz = pos_z_[i];
+
+        // Nearest-so-far, sorted by ascending distance. A candidate only costs an
+        // insertion when it beats the current k-th best.
+        float    best_dsq[TOPOLOGICAL_MAX_K];
+        uint16_t best_idx[TOPOLOGICAL_MAX_K];
+        size_t   found = 0;
+
+        for (size_t j = 0; j < num_boids_; j++) {
+            float dx = px - pos_x_[j];
+            float dy = py - pos_y_[j];
+            float dz = pz - pos_z_[j];
+            float dist_sq = dx * dx + dy * dy + dz * dz;
+            if (dist_sq < 0.00000001f) continue;  // self / coincident
+            if (found == k && dist_sq >= best_dsq[k - 1]) continue;
+
+            size_t slot = (found < k) ? found++ : k - 1;
+            while (slot > 0 && best_dsq[slot - 1] > dist_sq) {
+                best_dsq[slot] = best_dsq[slot - 1];
+                best_idx[slot] = best_idx[slot - 1];
+                slot--;
+            }
+            best_dsq[slot] = dist_sq;
+            best_idx[slot] = static_cast<uint16_t>(j);
+        }
 
-        // Cohesion: accumulate neighbor positions
-        coh_sum += boids_[i].position;
+        Vec3 sep, ali, coh;
+        for (size_t n = 0; n < found; n++) {
+            const size_t j = best_idx[n];
+            float inv_dsq = 1.0f / best_dsq[n];
+            sep += Vec3(px - pos_x_[j], py - pos_y_[j], pz - pos_z_[j]) * inv_dsq;
+            ali += GetVelocity(j);
+            coh += GetPosition(j);
+        }
+
+        sep_x_[i] = sep.x; sep_y_[i] = sep.y; sep_z_[i] = sep.z;
+        ali_x_[i] = ali.x; ali_y_[i] = ali.y; ali_z_[i] = ali.z;
+        coh_x_[i] = coh.x; coh_y_[i] = coh.y; coh_z_[i] = coh.z;
+        count_[i] = static_cast<float>(found);
     }
+}
 
-    if (count == 0) return Vec3(0.0f, 0.0f, 0.0f);
+template <size_t Capacity>
+size_t BoidsFlock<Capacity>::CellCoord(float v) const {
+    int c = static_cast<int>(v * static_cast<float>(grid_dim_));
+    if (c < 0) c = 0;
+    if (c >= static_cast<int>(grid_dim_)) c = static_cast<int>(grid_dim_) - 1;
+    return static_cast<size_t>(c);
+}
 
-    float inv_count = 1.0f / static_cast<float>(count);
+template <size_t Capacity>
+void BoidsFlock<Capacity>::BuildGrid(float min_cell) {
+    // Widest cell count that still keeps every cell >= min_cell
+    size_t dim = (min_cell > 0.0f) ? static_cast<size_t>(1.0f / min_cell) : 1;
+    if (dim < 1) dim = 1;
+    if (dim > GRID_MAX_DIM) dim = GRID_MAX_DIM;
+    grid_dim_ = dim;
+    const size_t num_cells = dim * dim * dim;
+
+    // Counting sort, pass 1: histogram of boids per cell
+    for (size_t c = 0; c <= num_cells; c++) {
+        cell_start_[c] = 0;
+    }
+    for (size_t i = 0; i < num_boids_; i++) {
+        size_t cell = (CellCoord(pos_z_[i]) * dim + CellCoord(pos_y_[i])) * dim
+                    + CellCoord(pos_x_[i]);
+        cell_of_[i] = static_cast<uint16_t>(cell);
+        cell_start_[cell + 1]++;
+    }
+
+    // Pass 2: prefix sum turns counts into each cell's first sorted slot
+    for (size_t c = 0; c < num_cells; c++) {
+        cell_start_[c + 1] += cell_start_[c];
+    }
+
+    // Pass 3: scatter into sorted order; fill[] is each cell's running insert cursor.
+    // Walking boids in index order keeps the sort stable.
+    uint16_t fill[GRID_MAX_CELLS];
+    for (size_t c = 0; c < num_cells; c++) {
+        fill[c] = cell_start_[c];
+    }
+    for (size_t i = 0; i < num_boids_; i++) {
+        size_t slot = fill[cell_of_[i]]++;
+        sorted_idx_[slot]   = static_cast<uint16_t>(i);
+        sorted_pos_x_[slot] = pos_x_[i];
+        sorted_pos_y_[slot] = pos_y_[i];
+        sorted_pos_z_[slot] = pos_z_[i];
+        sorted_vel_x_[slot] = vel_x_[i];
+        sorted_vel_y_[slot] = vel_y_[i];
+        sorted_vel_z_[slot] = vel_z_[i];
+    }
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumGridNeighbors(float radius_sq) {
+    const size_t dim = grid_dim_;
+
+    // Visit boids in sorted order: consecutive boids share cells, so the same
+    // neighbor runs stay hot in cache.
+    for (size_t slot = 0; slot < num_boids_; slot++) {
+        const size_t i  = sorted_idx_[slot];
+        if (lod_defer_[i]) continue;
+        const float  px = sorted_pos_x_[slot];
+        const float  py = sorted_pos_y_[slot];
+        const float  pz = sorted_pos_z_[slot];
+
+        const size_t cell = cell_of_[i];
+        const size_t cx = cell % dim;
+        const size_t cy = (cell / dim) % dim;
+        const size_t cz = cell / (dim * dim);
+        const size_t x_lo = (cx > 0) ? cx - 1 : 0;
+        const size_t x_hi = (cx + 1 < dim) ? cx + 1 : dim - 1;
+        const size_t y_lo = (cy > 0) ? cy - 1 : 0;
+        const size_t y_hi = (cy + 1 < dim) ? cy + 1 : dim - 1;
+        const size_t z_lo = (cz > 0) ? cz - 1 : 0;
+        const size_t z_hi = (cz + 1 < dim) ? cz + 1 : dim - 1;
+
+        Vec3  sep, ali, coh;
+        float count = 0.0f;
+
+        for (size_t z = z_lo; z <= z_hi; z++) {
+            for (size_t y = y_lo; y <= y_hi; y++) {
+                // Cells x_lo..x_hi of this row are adjacent in sorted order
+                size_t row   = (z * dim + y) * dim;
+                size_t begin = cell_start_[row + x_lo];
+                size_t end   = cell_start_[row + x_hi + 1];
+                stats_.pair_tests += static_cast<uint32_t>(end - begin);
+
+                for (size_t j = begin; j < end; j++) {
+                    float dx = px - sorted_pos_x_[j];
+                    float dy = py - sorted_pos_y_[j];
+                    float dz = pz - sorted_pos_z_[j];
+                    float dist_sq = dx * dx + dy * dy + dz * dz;
+                    if (dist_sq >= radius_sq || dist_sq < 0.00000001f) continue;
+
+                    float inv_dsq = 1.0f / dist_sq;
+                    sep += Vec3(dx * inv_dsq, dy * inv_dsq, dz * inv_dsq);
+                    ali += Vec3(sorted_vel_x_[j], sorted_vel_y_[j], sorted_vel_z_[j]);
+                    coh += Vec3(sorted_pos_x_[j], sorted_pos_y_[j], sorted_pos_z_[j]);
+                    count += 1.0f;
+                }
+            }
+        }
+
+        sep_x_[i] = sep.x; sep_y_[i] = sep.y; sep_z_[i] = sep.z;
+        ali_x_[i] = ali.x; ali_y_[i] = ali.y; ali_z_[i] = ali.z;
+        coh_x_[i] = coh.x; coh_y_[i] = coh.y; coh_z_[i] = coh.z;
+        count_[i] = count;
+    }
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::BuildCellAggregates() {
+    const size_t num_cells = grid_dim_ * grid_dim_ * grid_dim_;
+    for (size_t c = 0; c < num_cells; c++) {
+        const size_t begin = cell_start_[c];
+        const size_t end   = cell_start_[c + 1];
+        if (begin == end) continue;
+
+        Vec3 pos, vel;
+        for (size_t j = begin; j < end; j++) {
+            pos += Vec3(sorted_pos_x_[j], sorted_pos_y_[j], sorted_pos_z_[j]);
+            vel += Vec3(sorted_vel_x_[j], sorted_vel_y_[j], sorted_vel_z_[j]);
+        }
+        const float inv_n = 1.0f / static_cast<float>(end - begin);
+        cell_pos_x_[begin] = pos.x * inv_n;
+        cell_pos_y_[begin] = pos.y * inv_n;
+        cell_pos_z_[begin] = pos.z * inv_n;
+        cell_vel_x_[begin] = vel.x * inv_n;
+        cell_vel_y_[begin] = vel.y * inv_n;
+        cell_vel_z_[begin] = vel.z * inv_n;
+    }
+}
+
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumMeanFieldNeighbors(const BoidsParams& params) {
+    const size_t dim    = grid_dim_;
+    const float  cell_w = 1.0f / static_cast<float>(dim);
+    const float  radius = params.perception_radius;
+    const float  radius_sq = radius * radius;
+    // Opening criterion cell_w < theta * d, compared squared
+    const float  open_sq = (params.mean_field_theta > 0.0f)
+                         ? cell_w * cell_w / (params.mean_field_theta * params.mean_field_theta)
+                         : 1e30f;
+    // Cells to either side that the perception sphere can reach
+    size_t reach = static_cast<size_t>(ceilf(radius / cell_w));
+    if (reach > dim) reach = dim;
+
+    for (size_t slot = 0; slot < num_boids_; slot++) {
+        const size_t i  = sorted_idx_[slot];
+        if (lod_defer_[i]) continue;
+        const float  px = sorted_pos_x_[slot];
+        const float  py = sorted_pos_y_[slot];
+        const float  pz = sorted_pos_z_[slot];
+
+        const size_t own = cell_of_[i];
+        const size_t cy = (own / dim) % dim;
+        const size_t cz = own / (dim * dim);
+        const size_t y_lo = (cy > reach) ? cy - reach : 0;
+        const size_t y_hi = (cy + reach < dim) ? cy + reach : dim - 1;
+        const size_t z_lo = (cz > reach) ? cz - reach : 0;
+        const size_t z_hi = (cz + reach < dim) ? cz + reach : dim - 1;
+
+        Vec3  sep, ali, coh;
+        float count = 0.0f;
+
+        for (size_t z = z_lo; z <= z_hi; z++) {
+            // Per-axis gap between the boid and the cell's box (0 inside its slab)
+            const float gz = fmaxf(fmaxf(static_cast<float>(z) * cell_w - pz,
+                                         pz - static_cast<float>(z + 1) * cell_w), 0.0f);
+            for (size_t y = y_lo; y <= y_hi; y++) {
+                const float gy = fmaxf(fmaxf(static_cast<float>(y) * cell_w - py,
+                                             py - static_cast<float>(y + 1) * cell_w), 0.0f);
+                // Clip the row to the sphere's chord through it; rows it misses are skipped
+                const float chord_sq = radius_sq - gy * gy - gz * gz;
+                if (chord_sq <= 0.0f) continue;
+                const float chord = sqrtf(chord_sq);
+                const size_t x_hi = CellCoord(px + chord);
+                const size_t row  = (z * dim + y) * dim;
+                for (size_t x = CellCoord(px - chord); x <= x_hi; x++) {
+                    const size_t c     = row + x;
+                    const size_t begin = cell_start_[c];
+                    const size_t end   = cell_start_[c + 1];
+                    if (begin == end) continue;
+
+                    const float dx = px - cell_pos_x_[begin];
+                    const float dy = py - cell_pos_y_[begin];
+                    const float dz = pz - cell_pos_z_[begin];
+                    const float dist_sq = dx * dx + dy * dy + dz * dz;
+                    if (c != own && dist_sq > open_sq) {
+                        // Far cell. Where the sphere's surface cuts through it, count the
+                        // share of the cell inside, treating the surface as a plane and the
+                        // boids as spread evenly over the cell's extent toward the boid;
+                        // that share's centroid sits correspondingly closer to the boid.
+                        const float dist   = sqrtf(dist_sq);
+                        const float extent = cell_w * (fabsf(dx) + fabsf(dy) + fabsf(dz)) / dist;
+                        float inside = 0.5f + (radius - dist) / extent;
+                        if (inside <= 0.0f) continue;
+                        if (inside > 1.0f) inside = 1.0f;
+                        const float shift = (1.0f - inside) * 0.5f * extent / dist;
+                        const float n     = static_cast<float>(end - begin) * inside;
+                        const float qx = cell_pos_x_[begin] + dx * shift;
+                        const float qy = cell_pos_y_[begin] + dy * shift;
+                        const float qz = cell_pos_z_[begin] + dz * shift;
+                        const float near = dist * (1.0f - shift);
+                        const float inv_dsq = n * (1.0f - shift) / (near * near);
+                        sep += Vec3(dx * inv_dsq, dy * inv_dsq, dz * inv_dsq);
+                        ali += Vec3(cell_vel_x_[begin], cell_vel_y_[begin], cell_vel_z_[begin]) * n;
+                        coh += Vec3(qx, qy, qz) * n;
+                        count += n;
+                        stats_.mean_field_cells++;
+                        continue;
+                    }
+
+                    stats_.pair_tests += static_cast<uint32_t>(end - begin);
+                    for (size_t j = begin; j < end; j++) {
+                        float ex = px - sorted_pos_x_[j];
+                        float ey = py - sorted_pos_y_[j];
+                        float ez = pz - sorted_pos_z_[j];
+                        float d_sq = ex * ex + ey * ey + ez * ez;
+                        if (d_sq >= radius_sq || d_sq < 0.00000001f) continue;
+
+                        float inv_dsq = 1.0f / d_sq;
+                        sep += Vec3(ex * inv_dsq, ey * inv_dsq, ez * inv_dsq);
+                        ali += Vec3(sorted_vel_x_[j], sorted_vel_y_[j], sorted_vel_z_[j]);
+                        coh += Vec3(sorted_pos_x_[j], sorted_pos_y_[j], sorted_pos_z_[j]);
+                        count += 1.0f;
+                    }
+                }
+            }
+        }
+
+        sep_x_[i] = sep.x; sep_y_[i] = sep.y; sep_z_[i] = sep.z;
+        ali_x_[i] = ali.x; ali_y_[i] = ali.y; ali_z_[i] = ali.z;
+        coh_x_[i] = coh.x; coh_y_[i] = coh.y; coh_z_[i] = coh.z;
+        count_[i] = count;
+    }
+}
+
+template <size_t Capacity>
+NeighborSums BoidsFlock<Capacity>::GetNeighborSums(size_t i) const {
+    return FlockKernel::NeighborSumsAt(*this, i);
+}
+
+Vec3 SteerFromNeighbors(const NeighborSums& sums, const Vec3& pos, const Vec3& vel,
+                        const BoidsParams& params) {
+    if (sums.count < 0.5f) return Vec3(0.0f, 0.0f, 0.0f);
+
+    float inv_count = 1.0f / sums.count;
     Vec3 force(0.0f, 0.0f, 0.0f);
 
     // Separation steering
-    sep_sum *= inv_count;
-    if (sep_sum.MagnitudeSquared() > 0.0f) {
-        sep_sum.SetMagnitude(params.max_speed);
-        sep_sum = sep_sum - vel;
-        sep_sum.Limit(params.max_force);
-        force += sep_sum * params.separation_weight;
+    Vec3 sep = sums.separation * inv_count;
+    if (sep.MagnitudeSquared() > 0.0f) {
+        sep.SetMagnitude(params.max_speed);
+        sep = sep - vel;
+        sep.Limit(params.max_force);
+        force += sep * params.separation_weight;
     }
 
     // Alignment steering
-    ali_sum *= inv_count;
-    ali_sum.SetMagnitude(params.max_speed);
-    Vec3 ali_steer = ali_sum - vel;
+    Vec3 ali = sums.alignment * inv_count;
+    ali.SetMagnitude(params.max_speed);
+    Vec3 ali_steer = ali - vel;
     ali_steer.Limit(params.max_force);
     force += ali_steer * params.alignment_weight;
 
     // Cohesion steering
-    coh_sum *= inv_count;
-    Vec3 desired = coh_sum - pos;
+    Vec3 desired = sums.cohesion * inv_count - pos;
     desired.SetMagnitude(params.max_speed);
     Vec3 coh_steer = desired - vel;
     coh_steer.Limit(params.max_force);
@@ -133,7 +547,13 @@ Vec3 BoidsFlock::ApplyFlockingForces(size_t boid_idx, const BoidsParams& params)
     return force;
 }
 
-Vec3 BoidsFlock::ComputeBoundaryForce(const Vec3& pos) {
+template <size_t Capacity>
+Vec3 BoidsFlock<Capacity>::ApplyFlockingForces(size_t boid_idx, const BoidsParams& params) {
+    return SteerFromNeighbors(GetNeighborSums(boid_idx),
+                              GetPosition(boid_idx), GetVelocity(boid_idx), params);
+}
+
+Vec3 BoundaryForce(const Vec3& pos) {
     Vec3 force(0.0f, 0.0f, 0.0f);
     float t;
 
@@ -167,74 +587,155 @@ Vec3 BoidsFlock::ComputeBoundaryForce(const Vec3& pos) {
     return force;
 }
 
-void BoidsFlock::ClampPosition(Vec3& pos) {
-    // Guard against non-finite values
-    if (!std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z)) {
-        pos.x = 0.5f;
-        pos.y = 0.5f;
-        pos.z = 0.5f;
-        return;
+template <size_t Capacity>
+void BoidsFlock<Capacity>::SumNeighbors(const BoidsParams& params) {
+    float radius_sq = params.perception_radius * params.perception_radius;
+    const uint32_t start_us = stats_clock_ ? stats_clock_() : 0;
+    bool verlet_cached = false;
+    switch (params.neighbor_search) {
+        case NeighborSearch::GRID:
+            BuildGrid(params.perception_radius);
+            SumGridNeighbors(radius_sq);
+            break;
+        case NeighborSearch::PAIRWISE:
+            SumPairwiseNeighbors(radius_sq);
+            break;
+        case NeighborSearch::VERLET:
+            verlet_cached = SumVerletNeighbors(params);
+            break;
+        case NeighborSearch::TOPOLOGICAL:
+            SumNearestNeighbors(params.topological_k);
+            break;
+        case NeighborSearch::MEAN_FIELD:
+            BuildGrid(params.perception_radius / MEAN_FIELD_CELLS_PER_RADIUS);
+            BuildCellAggregates();
+            SumMeanFieldNeighbors(params);
+            break;
+        case NeighborSearch::BRUTE_FORCE:
+        default:
+            SumAllNeighbors(radius_sq);
+            break;
+    }
+    if (stats_clock_) {
+        const uint32_t elapsed_us = stats_clock_() - start_us;
+        stats_.neighbor_us += elapsed_us;
+        if (verlet_cached) stats_.verlet_cached_us += elapsed_us;
     }
+}
 
-    // Hard clamp to [0, 1] as safety net
-    if (pos.x < 0.0f) pos.x = 0.0f;
-    else if (pos.x > 1.0f) pos.x = 1.0f;
-    if (pos.y < 0.0f) pos.y = 0.0f;
-    else if (pos.y > 1.0f) pos.y = 1.0f;
-    if (pos.z < 0.0f) pos.z = 0.0f;
-    else if (pos.z > 1.0f) pos.z = 1.0f;
+template <size_t Capacity>
+void BoidsFlock<Capacity>::ComputeFlockingForces(const BoidsParams& params, Vec3* forces) {
+    if (!initialized_) return;
+    for (size_t i = 0; i < num_boids_; i++) lod_defer_[i] = 0;
+    SumNeighbors(params);
+    for (size_t i = 0; i < num_boids_; i++) {
+        forces[i] = ApplyFlockingForces(i, params);
+    }
 }
 
-void BoidsFlock::Update(float dt, const BoidsParams& params) {
+template <size_t Capacity>
+void BoidsFlock<Capacity>::Update(float dt, const BoidsParams& params) {
     if (!initialized_ || num_boids_ == 0) return;
 
-    // Apply flocking + boundary + wander forces
+    stats_.ticks++;
+    state_version_++;
+
+    // Level of detail: a quiet boid (far, or isolated when it last steered) steers only
+    // on every stride-th step, staggered by index so deferred work spreads evenly over
+    // steps. When it does steer, its velocity update covers all the time since it last
+    // did; in between it keeps gliding on its held velocity. Deciding this before the
+    // neighbor pass lets the pass skip pairs where both boids are deferred.
+    size_t stride = params.lod_stride;
+    if (stride < 1) stride = 1;
+    if (stride > LOD_MAX_STRIDE) stride = LOD_MAX_STRIDE;
+    lod_phase_++;
+
     for (size_t i = 0; i < num_boids_; i++) {
-        Vec3 flocking = ApplyFlockingForces(i, params);
-        boids_[i].ApplyForce(flocking);
+        lod_elapsed_[i] += dt;
+        const bool quiet = pos_z_[i] > LOD_FAR_Z || lod_isolated_[i];
+        const bool defer = stride > 1 && quiet && (lod_phase_ + i) % stride != 0;
+        lod_defer_[i] = defer;
+        if (defer) {
+            force_dt_[i] = 0.0f;
+            stats_.lod_deferred++;
+        } else {
+            force_dt_[i]    = lod_elapsed_[i];
+            lod_elapsed_[i] = 0.0f;
+        }
+    }
 
-        Vec3 boundary = ComputeBoundaryForce(boids_[i].position);
-        boids_[i].ApplyForce(boundary);
+    SumNeighbors(params);
 
-        // Wander: drift the angle slowly, apply a constant-magnitude force in that direction.
-        // Using only x-y keeps z independent; the angle drifts as a random walk so
-        // consecutive ticks push in similar directions — creating smooth arcs, not jitter.
-        boids_[i].wander_angle += (Random01() - 0.5f) * WANDER_TURN_RATE;
-        Vec3 wander(cosf(boids_[i].wander_angle) * WANDER_STRENGTH,
-                    sinf(boids_[i].wander_angle) * WANDER_STRENGTH,
-                    0.0f);
-        boids_[i].ApplyForce(wander);
+    // Apply flocking + environment forces, then wander on top. Deferred boids' neighbor
+    // sums may be partial; they are neither used nor counted toward crowding.
+    float  neighbors = 0.0f;
+    size_t steering  = 0;
+    for (size_t i = 0; i < num_boids_; i++) {
+        if (lod_defer_[i]) continue;
+        neighbors += count_[i];
+        steering++;
+        lod_isolated_[i] = count_[i] < 0.5f;
+
+        Vec3 force = ApplyFlockingForces(i, params);
+        const Vec3 pos = GetPosition(i);
+        force += BoundaryForce(pos);
+
+        acc_x_[i] = force.x;
+        acc_y_[i] = force.y;
+        acc_z_[i] = force.z;
     }
+    // Crowding for adaptive stepping
+    if (steering > 0) mean_neighbors_ = neighbors / static_cast<float>(steering);
+    FlockKernel::Wander(*this, 0, PaddedCount(), dt);
 
     // Update physics
     for (size_t i = 0; i < num_boids_; i++) {
-        boids_[i].velocity += boids_[i].acceleration * dt;
-        boids_[i].velocity.Limit(params.max_speed);
-        boids_[i].position += boids_[i].velocity * dt;
-        boids_[i].acceleration = Vec3(0.0f, 0.0f, 0.0f);
-
-        ClampPosition(boids_[i].position);
+        FlockKernel::IntegrateBoid(*this, i, force_dt_[i], dt, params.max_speed);
     }
 }
 
-int BoidsFlock::GetCellDensity(size_t grid_x, size_t grid_y) const {
-    if (grid_x >= LED_GRID_DIM || grid_y >= LED_GRID_DIM) return 0;
+template <size_t Capacity>
+float BoidsFlock<Capacity>::ChooseStepDt(const BoidsParams& params) const {
+    float dt = (params.max_speed > 0.0f) ? FLOCK_STEP_TRAVEL / params.max_speed : FLOCK_MAX_DT;
+    dt /= 1.0f + mean_neighbors_ / FLOCK_CROWD_NEIGHBORS;
+    if (dt < FLOCK_FIXED_DT) dt = FLOCK_FIXED_DT;
+    if (dt > FLOCK_MAX_DT) dt = FLOCK_MAX_DT;
+    return dt;
+}
 
-    int count = 0;
-    for (size_t i = 0; i < num_boids_; i++) {
-        int gx = static_cast<int>(boids_[i].position.x * LED_GRID_DIM);
-        int gy = static_cast<int>(boids_[i].position.y * LED_GRID_DIM);
-        // Clamp to valid range
-        if (gx < 0) gx = 0;
-        if (gx >= static_cast<int>(LED_GRID_DIM)) gx = static_cast<int>(LED_GRID_DIM) - 1;
-        if (gy < 0) gy = 0;
-        if (gy >= static_cast<int>(LED_GRID_DIM)) gy = static_cast<int>(LED_GRID_DIM) - 1;
-
-        if (static_cast<size_t>(gx) == grid_x && static_cast<size_t>(gy) == grid_y) {
-            count++;
+template <size_t Capacity>
+size_t BoidsFlock<Capacity>::Advance(float elapsed, const BoidsParams& params,
+                                     size_t max_steps) {
+    if (!initialized_) return 0;
+    if (elapsed > 0.0f) accumulator_ += elapsed;
+    if (max_steps > FLOCK_MAX_SUBSTEPS) max_steps = FLOCK_MAX_SUBSTEPS;
+
+    // One step length per call, so alpha_ always refers to a single step
+    const float dt = params.adaptive_step ? ChooseStepDt(params) : FLOCK_FIXED_DT;
+    const uint32_t dt_us = static_cast<uint32_t>(dt * 1000000.0f + 0.5f);
+    constexpr uint32_t fixed_us = static_cast<uint32_t>(FLOCK_FIXED_DT * 1000000.0f + 0.5f);
+    step_dt_ = dt;
+    stats_.step_interval_us = dt_us;
+
+    auto step = [&]() {
+        SnapPrevious(0, num_boids_);
+        Update(dt, params);
+
+        // Count the fixed-rate steps this longer step stood in for
+        saved_us_ += dt_us - fixed_us;
+        while (saved_us_ >= fixed_us) {
+            stats_.steps_saved++;
+            saved_us_ -= fixed_us;
         }
-    }
-    return count;
+    };
+    const size_t steps = FlockKernel::RunFixedSteps(accumulator_, dt, max_steps,
+                                                    stats_.dropped_steps, step);
+
+    alpha_ = accumulator_ / dt;
+    return steps;
 }
 
+// Capacities built into this binary
+template class BoidsFlock<MAX_BOIDS>;
+
 } // namespace murmur
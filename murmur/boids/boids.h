@@ -3,13 +3,63 @@
 #define BOIDS_H
 
 #include "vec3.h"
+#include "flock_analytics.h"
 #include <cstdint>
 #include <cstddef>
+#include <cmath>
 
 namespace murmur {
 
-constexpr size_t MAX_BOIDS = 16;
-constexpr size_t LED_GRID_DIM = 4;  // 4x4 LED grid for density visualization
+// Flock capacity of this build, shared by the flock, voice bank, scheduler and UI.
+// Override per build with -DMURMUR_MAX_BOIDS=<n> (see the Makefile's lean / visual targets).
+#ifndef MURMUR_MAX_BOIDS
+#define MURMUR_MAX_BOIDS 16
+#endif
+constexpr size_t MAX_BOIDS = MURMUR_MAX_BOIDS;
+
+// Array padding granularity. The neighbor kernel sweeps all boids as one stream of
+// independent lanes; padding to a multiple of the SIMD width lets the host compiler emit
+// packed math with no scalar tail, and on the Cortex-M7 keeps the FPU pipeline full.
+constexpr size_t KERNEL_LANES = 4;
+constexpr size_t PaddedCapacity(size_t capacity) {
+    return (capacity + KERNEL_LANES - 1) / KERNEL_LANES * KERNEL_LANES;
+}
+
+// Unused lanes past num_boids are parked here, far outside any perception radius,
+// so the kernel never needs a tail loop or a per-lane bounds check.
+constexpr float PADDING_POSITION = 1000.0f;
+
+// Uniform neighbor grid over the unit cube. Cells are at least perception_radius wide,
+// so a boid's neighbors always lie in its own or one of the 26 adjacent cells.
+constexpr size_t GRID_MAX_DIM   = 8;  // cells per axis upper bound
+constexpr size_t GRID_MAX_CELLS = GRID_MAX_DIM * GRID_MAX_DIM * GRID_MAX_DIM;
+
+// Mean-field neighbor search (NeighborSearch::MEAN_FIELD): grid cells are about
+// perception_radius / MEAN_FIELD_CELLS_PER_RADIUS wide (still capped by GRID_MAX_DIM), so
+// the perception sphere spans several cells and the distant ones can be summarized.
+constexpr float MEAN_FIELD_CELLS_PER_RADIUS = 4.0f;
+
+// Topological neighborhoods: upper bound on BoidsParams::topological_k
+constexpr size_t TOPOLOGICAL_MAX_K = 12;
+
+// Verlet neighbor lists: pair storage budget per boid. Lists hold each pair once
+// (j > i); if a dense flock overflows the budget the tick falls back to PAIRWISE, and so
+// do the next VERLET_OVERFLOW_BACKOFF ticks before the list is tried again (a flock that
+// overflowed once is likely still dense, and a failed build costs up to a PAIRWISE pass).
+constexpr size_t VERLET_PAIRS_PER_BOID   = 16;
+constexpr size_t VERLET_OVERFLOW_BACKOFF = 64;
+
+// Fixed-step integration: Advance() runs whole FLOCK_FIXED_DT steps and interpolates
+// the remainder, so simulation cost per call is bounded and dt never varies.
+constexpr float  FLOCK_FIXED_DT      = 0.002f;  // one simulation step (500 Hz)
+constexpr size_t FLOCK_MAX_SUBSTEPS  = 4;       // catch-up cap; older backlog is dropped
+
+// Adaptive stepping (BoidsParams::adaptive_step): the step grows from FLOCK_FIXED_DT up to
+// FLOCK_MAX_DT while the fastest boid still travels at most FLOCK_STEP_TRAVEL per step,
+// and shrinks again as the flock crowds together (stiffer separation forces).
+constexpr float FLOCK_MAX_DT          = 0.008f;   // ceiling (125 Hz)
+constexpr float FLOCK_STEP_TRAVEL     = 0.0015f;  // max_speed 0.75 and up keeps 2 ms steps
+constexpr float FLOCK_CROWD_NEIGHBORS = 4.0f;     // mean neighbor count that halves the step
 
 // Boundary avoidance constants
 constexpr float BOUNDARY_MARGIN_XY  = 0.25f;  // margin on x and y edges (wider = earlier turns)
@@ -22,6 +72,17 @@ constexpr float BOUNDARY_FORCE_Z    = 0.08f;   // 2x max_force for z boundaries
 constexpr float WANDER_STRENGTH  = 0.16f;  // force magnitude (~40% of default max_force)
 constexpr float WANDER_TURN_RATE = 0.40f;  // how fast wander angle drifts per tick (rad)
 
+// Level of detail (BoidsParams::lod_stride): quiet boids, either far away (quiet voices)
+// or without neighbors, re-evaluate their steering only every lod_stride steps. Not
+// applied to BRUTE_FORCE's neighbor sweep, which always covers every lane.
+constexpr float  LOD_FAR_Z      = 0.7f;  // z above this maps to a voice near AMP_FLOOR
+constexpr size_t LOD_MAX_STRIDE = 8;
+
+// Analytic soft walls: quadratic push inside the margins of the unit cube
+Vec3 BoundaryForce(const Vec3& pos);
+
+// Snapshot of one boid. The flock stores its state as separate component arrays;
+// GetBoid() assembles one of these by value for callers that want a single record.
 struct Boid {
     Vec3 position;      // 0-1 range for all axes (x=pan, y=freq, z=amp)
     Vec3 velocity;
@@ -33,6 +94,20 @@ struct Boid {
     }
 };
 
+// How ApplyFlockingForces finds each boid's neighbors. All modes except MEAN_FIELD
+// produce the same forces up to float summation order.
+enum class NeighborSearch : uint8_t {
+    BRUTE_FORCE,  // vectorized all-pairs scan; cheapest for small flocks
+    GRID,         // uniform cell grid rebuilt every tick; O(N) for spread-out flocks. Beats
+                  // the scalar (M7) all-pairs scan from 16 boids up; on SIMD hosts, only
+                  // once the radius is small next to the flock (see host/flock_bench)
+    PAIRWISE,     // each unordered pair visited once, contributions added to both boids
+    VERLET,       // cached PAIRWISE list within radius + skin, rebuilt only after boids drift
+    TOPOLOGICAL,  // k nearest boids regardless of distance (starling-style), no radius
+    MEAN_FIELD,   // fine grid; far cells act as one pseudo-neighbor (approximate, see
+                  // BoidsParams::mean_field_theta)
+};
+
 struct BoidsParams {
     float separation_weight;  // 0-2
     float alignment_weight;   // 0-2
@@ -40,40 +115,313 @@ struct BoidsParams {
     float perception_radius;  // 0.05-0.5
     float max_speed;          // Maximum velocity magnitude
     float max_force;          // Maximum steering force
+    NeighborSearch neighbor_search = NeighborSearch::BRUTE_FORCE;
+    float verlet_skin = 0.05f;  // VERLET only: extra list radius beyond perception_radius
+    size_t topological_k = 7;   // TOPOLOGICAL only: neighbors per boid (1-TOPOLOGICAL_MAX_K)
+    // MEAN_FIELD only: a cell narrower than theta times its distance is one pseudo-neighbor
+    // (0 = exact). Accuracy vs. speed, formed flock of 250-4000 boids at radius 0.25 (host
+    // mean_field_bench; error relative to the mean force):
+    //   0.4 (default): error mean ~1.5%, p99 ~6%, max under 30%; ~0.5x brute force on a
+    //       SIMD host, 1.2-1.5x GRID;
+    //   1.0: 2.2x brute force at 4000 boids (slower below ~2000), error p99 ~22% but max
+    //       ~160%: where separation and cohesion nearly cancel, the summarized sum flips.
+    // Anything above ~0.45 lets those flips through.
+    float mean_field_theta = 0.4f;
+    bool adaptive_step = false; // Advance() picks the step from max_speed and crowding
+    size_t lod_stride = 1;      // quiet boids steer every Nth step (1 = all boids every step)
+};
+
+// Microsecond timestamp source for FlockStats' timings (daisy::System::GetUs on the
+// Daisy, a steady clock on the host). Only differences are used, so wrapping is fine.
+using StatsClock = uint32_t (*)();
+
+// Neighbor search instrumentation, accumulated across Update() calls until ResetStats().
+// The _us timings stay 0 unless a StatsClock is attached (BoidsFlock::SetStatsClock).
+struct FlockStats {
+    uint32_t ticks;                // Update() calls that ran the simulation
+    uint32_t pair_tests;           // boid-pair distance evaluations, including list rebuilds
+    uint32_t pair_tests_saved;     // evaluations avoided vs. a full PAIRWISE scan every tick
+    uint32_t verlet_rebuilds;      // VERLET list rebuilds (drift, parameter change or reset)
+    uint32_t verlet_overflows;     // VERLET ticks that fell back to PAIRWISE: failed builds
+                                   // (list too small) and the back-off ticks after them
+    uint32_t dropped_steps;        // fixed steps skipped by Advance() to cap catch-up work
+    uint32_t step_interval_us;     // step length chosen by the latest Advance() call
+    uint32_t steps_saved;          // FLOCK_FIXED_DT steps avoided by longer adaptive steps
+    uint32_t lod_deferred;         // per-boid steering updates postponed by the LOD scheduler
+    uint32_t mean_field_cells;     // MEAN_FIELD cells summed as one pseudo-neighbor
+    uint32_t verlet_cached_ticks;  // VERLET ticks that replayed the cached list
+    uint32_t neighbor_us;          // time in the neighbor pass, all ticks
+    uint32_t verlet_cached_us;     // part of neighbor_us on VERLET ticks that replayed the
+                                   // cached list
+};
+
+// Separation / alignment / cohesion sums over one boid's neighbors
+struct NeighborSums {
+    Vec3 separation;  // sum of (pos - neighbor) / dist^2
+    Vec3 alignment;   // sum of neighbor velocities
+    Vec3 cohesion;    // sum of neighbor positions
+    float count;
 };
 
+// Turns one boid's neighbor sums into the weighted steering force
+Vec3 SteerFromNeighbors(const NeighborSums& sums, const Vec3& pos, const Vec3& vel,
+                        const BoidsParams& params);
+
+// One wander step for one boid: advances its xorshift32 state and rotates its unit x-y
+// wander direction by a turn of up to +-turn_scale * 2^31 rad.
+// Small-angle rotation (cos t ~ 1 - t^2 / 2, sin t ~ t) plus one Newton step toward unit
+// length, so the rotation error never compounds. No trig and no shared state.
+inline void RotateWander(uint32_t& rng, float& wx, float& wy, float turn_scale) {
+    uint32_t s = rng;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    rng = s;
+
+    float t  = static_cast<float>(static_cast<int32_t>(s)) * turn_scale;
+    float c  = 1.0f - 0.5f * t * t;
+    float rx = wx * c - wy * t;
+    float ry = wx * t + wy * c;
+    float k  = 1.5f - 0.5f * (rx * rx + ry * ry);
+    wx = rx * k;
+    wy = ry * k;
+}
+
+// Wander turn_scale for a step of length dt. The turn per FLOCK_FIXED_DT step is uniform
+// in +-WANDER_TURN_RATE / 2; longer steps turn sqrt(dt / FLOCK_FIXED_DT) times as much,
+// which keeps the random walk's heading spread per second independent of the step length.
+inline float WanderTurnScale(float dt) {
+    return 0.5f * WANDER_TURN_RATE / 2147483648.0f * sqrtf(dt * (1.0f / FLOCK_FIXED_DT));
+}
+
+struct FlockKernel;
+
+// Flock of up to Capacity boids. All state is sized from Capacity at compile time, so a
+// build pays only for the boids it can run. Member definitions live in boids.cpp and are
+// instantiated there for MAX_BOIDS; the per-lane code shared with MultiFlock is in
+// flock_kernel.h.
+template <size_t Capacity>
 class BoidsFlock {
+    friend struct FlockKernel;
+
 public:
-    BoidsFlock() : num_boids_(0), initialized_(false) {}
+    static constexpr size_t kCapacity = Capacity;
+
+    BoidsFlock()
+        : accumulator_(0.0f), alpha_(0.0f), step_dt_(FLOCK_FIXED_DT),
+          saved_us_(0), mean_neighbors_(0.0f), lod_phase_(0), grid_dim_(1), verlet_valid_(false), verlet_cutoff_(0.0f),
+          verlet_backoff_(0),
+          stats_clock_(nullptr), stats_(),
+          analytics_(), state_version_(0), num_boids_(0), initialized_(false) {}
     ~BoidsFlock() {}
 
     void Init(size_t num_boids);
+    // Single integration step of length dt
     void Update(float dt, const BoidsParams& params);
+    // Fixed-step driver: adds elapsed seconds to the accumulator and runs zero or more
+    // FLOCK_FIXED_DT steps (at most max_steps, itself capped at FLOCK_MAX_SUBSTEPS).
+    // Returns the steps run. With params.adaptive_step the step length is re-chosen on
+    // each call instead.
+    size_t Advance(float elapsed, const BoidsParams& params,
+                   size_t max_steps = FLOCK_MAX_SUBSTEPS);
     void Scatter();  // Randomize positions
+    // Flocking force on every boid for the current state with params.neighbor_search,
+    // without stepping (forces[0 .. num_boids)). Host accuracy checks compare the
+    // approximate modes against BRUTE_FORCE with it.
+    void ComputeFlockingForces(const BoidsParams& params, Vec3* forces);
 
     void SetNumBoids(size_t num);
+    // Trace replay: places boid index at pos with velocity vel, without simulating. The
+    // interpolation history is collapsed to this state.
+    void SetBoidState(size_t index, const Vec3& pos, const Vec3& vel);
     size_t GetNumBoids() const { return num_boids_; }
-    const Boid& GetBoid(size_t index) const { return boids_[index]; }
+    Boid GetBoid(size_t index) const;
+    Vec3 GetPosition(size_t index) const {
+        return Vec3(pos_x_[index], pos_y_[index], pos_z_[index]);
+    }
+    Vec3 GetVelocity(size_t index) const {
+        return Vec3(vel_x_[index], vel_y_[index], vel_z_[index]);
+    }
+    // Position blended between the last two fixed steps by the leftover accumulator
+    // time. Use this for anything driven faster or slower than the step rate.
+    Vec3 GetInterpolatedPosition(size_t index) const {
+        return Vec3(prev_pos_x_[index] + (pos_x_[index] - prev_pos_x_[index]) * alpha_,
+                    prev_pos_y_[index] + (pos_y_[index] - prev_pos_y_[index]) * alpha_,
+                    prev_pos_z_[index] + (pos_z_[index] - prev_pos_z_[index]) * alpha_);
+    }
+    // Seconds the newest step lags behind the Advance() caller's clock (the unsimulated
+    // remainder). GetPosition() + GetVelocity() * t extrapolates from that point.
+    float GetStateAge() const { return accumulator_; }
+
+    const FlockStats& GetStats() const { return stats_; }
+    void ResetStats() { stats_ = FlockStats(); }
+    // Times the neighbor pass with clock (two calls per tick); nullptr stops timing
+    void SetStatsClock(StatsClock clock) { stats_clock_ = clock; }
+
+    // Density grid, centroid, spread, speed and polarization of the current step.
+    // Computed on first use after the flock changes, so any number of readers per tick
+    // share one pass over the boids.
+    const FlockAnalytics& GetAnalytics() const {
+        if (analytics_.version != state_version_) {
+            ComputeFlockAnalytics(*this, analytics_);
+            analytics_.version = state_version_;
+        }
+        return analytics_;
+    }
 
     // Get boid density in a grid cell (for LED visualization, x-y projection)
-    // Computes directly from boid positions (no spatial grid needed)
-    int GetCellDensity(size_t grid_x, size_t grid_y) const;
+    int GetCellDensity(size_t grid_x, size_t grid_y) const {
+        if (grid_x >= LED_GRID_DIM || grid_y >= LED_GRID_DIM) return 0;
+        return GetAnalytics().density[grid_x][grid_y];
+    }
 
 private:
-    // Single-pass flocking: computes separation + alignment + cohesion in one neighbor traversal
+    static constexpr size_t kPadded = PaddedCapacity(Capacity);
+    static_assert(Capacity > 0, "flock needs at least one boid");
+    static_assert(kPadded <= 0xFFFF && GRID_MAX_CELLS <= 0xFFFF,
+                  "grid indices are stored as uint16_t");
+    static_assert(Capacity * VERLET_PAIRS_PER_BOID <= 0xFFFF,
+                  "Verlet list offsets are stored as uint16_t");
+
+    // Fills the per-boid neighbor accumulators with params.neighbor_search
+    void SumNeighbors(const BoidsParams& params);
+    // Single-pass flocking: accumulates separation + alignment + cohesion sums for every
+    // boid at once. Each source boid is broadcast against all (padded) lanes, so the inner
+    // loop is a branchless elementwise update the compiler can vectorize.
+    void SumAllNeighbors(float radius_sq);
+    // Symmetric path: visits each unordered pair once (j > i) and applies the
+    // separation / alignment / cohesion terms to both boids, halving distance tests.
+    void SumPairwiseNeighbors(float radius_sq);
+    // Verlet path: replays a cached pair list built with a perception_radius + skin
+    // cutoff. The list is rebuilt once any boid has moved more than skin / 2 since the
+    // last build, which guarantees no pair can have entered the perception radius unseen.
+    // Returns true if this tick replayed the cached list (no rebuild, no fallback).
+    bool SumVerletNeighbors(const BoidsParams& params);
+    bool BuildVerletList(float cutoff);
+    bool VerletListStale(float cutoff, float skin) const;
+    // Topological path: each boid keeps its k nearest boids in a small sorted buffer
+    // (bounded insertion, O(N * k) per boid, no full sort) and sums over exactly those.
+    void SumNearestNeighbors(size_t k);
+    // Grid path: counting-sorts boids into cells, then scans only the 3x3x3 block of
+    // cells around each boid. Fills the same accumulators as SumAllNeighbors().
+    void BuildGrid(float min_cell);
+    void SumGridNeighbors(float radius_sq);
+    // Mean-field path (Barnes-Hut style): a finer grid plus each occupied cell's centroid
+    // and mean velocity. Cells that cannot reach the perception sphere are skipped, the
+    // boid's own cell and cells that look wide from the boid are summed boid by boid, and
+    // the rest count as their boid count of neighbors at the centroid.
+    void BuildCellAggregates();
+    void SumMeanFieldNeighbors(const BoidsParams& params);
+    size_t CellCoord(float v) const;
+    NeighborSums GetNeighborSums(size_t boid_idx) const;
     Vec3 ApplyFlockingForces(size_t boid_idx, const BoidsParams& params);
-    Vec3 ComputeBoundaryForce(const Vec3& pos);
-    void ClampPosition(Vec3& pos);
 
-    Boid boids_[MAX_BOIDS];
+    void InitBoid(size_t index);
+    void SnapPrevious(size_t from, size_t to);  // no interpolation across teleports
+    void ParkPadding();  // move lanes [num_boids_, kPadded) out of range
+    size_t PaddedCount() const { return PaddedCapacity(num_boids_); }
+
+    // Structure-of-arrays state: one contiguous, 16-byte aligned array per component
+    alignas(16) float pos_x_[kPadded];
+    alignas(16) float pos_y_[kPadded];
+    alignas(16) float pos_z_[kPadded];
+    alignas(16) float vel_x_[kPadded];
+    alignas(16) float vel_y_[kPadded];
+    alignas(16) float vel_z_[kPadded];
+    alignas(16) float acc_x_[kPadded];
+    alignas(16) float acc_y_[kPadded];
+    alignas(16) float acc_z_[kPadded];
+    // Wander direction (unit vector in x-y) and per-boid xorshift32 state (never 0)
+    alignas(16) float    wander_x_[kPadded];
+    alignas(16) float    wander_y_[kPadded];
+    alignas(16) uint32_t wander_rng_[kPadded];
+
+    // Fixed-step state: positions before the latest step, for interpolation
+    float prev_pos_x_[kPadded];
+    float prev_pos_y_[kPadded];
+    float prev_pos_z_[kPadded];
+    float accumulator_;  // unsimulated time (s), always < step_dt_ after Advance()
+    float alpha_;        // accumulator_ / step_dt_
+    float step_dt_;      // step length of the latest Advance() call
+
+    // Adaptive stepping: choice of step length, and leftover time (us) toward the next
+    // whole FLOCK_FIXED_DT step saved
+    float ChooseStepDt(const BoidsParams& params) const;
+    uint32_t saved_us_;
+    float mean_neighbors_;  // mean count_ of the latest step
+
+    // Level of detail: time since each boid last steered, the velocity-update time of
+    // the current step (0 while deferred), per-boid flags and the stagger counter
+    float    lod_elapsed_[kPadded];
+    float    force_dt_[kPadded];
+    uint8_t  lod_isolated_[kPadded];  // no neighbors at the boid's last steering update
+    uint8_t  lod_defer_[kPadded];     // skips steering this step
+    uint32_t lod_phase_;
+
+    // Per-boid neighbor accumulators written by SumAllNeighbors()
+    alignas(16) float sep_x_[kPadded];
+    alignas(16) float sep_y_[kPadded];
+    alignas(16) float sep_z_[kPadded];
+    alignas(16) float ali_x_[kPadded];
+    alignas(16) float ali_y_[kPadded];
+    alignas(16) float ali_z_[kPadded];
+    alignas(16) float coh_x_[kPadded];
+    alignas(16) float coh_y_[kPadded];
+    alignas(16) float coh_z_[kPadded];
+    alignas(16) float count_[kPadded];
+
+    // Neighbor grid, rebuilt each tick in GRID mode. cell_start_ is the counting-sort
+    // prefix sum: cell c holds sorted slots [cell_start_[c], cell_start_[c + 1]).
+    // Cells are numbered x-fastest, so an x-row of adjacent cells is one contiguous run.
+    size_t   grid_dim_;
+    uint16_t cell_start_[GRID_MAX_CELLS + 1];
+    uint16_t cell_of_[kPadded];
+    uint16_t sorted_idx_[kPadded];
+    alignas(16) float sorted_pos_x_[kPadded];
+    alignas(16) float sorted_pos_y_[kPadded];
+    alignas(16) float sorted_pos_z_[kPadded];
+    alignas(16) float sorted_vel_x_[kPadded];
+    alignas(16) float sorted_vel_y_[kPadded];
+    alignas(16) float sorted_vel_z_[kPadded];
+    // MEAN_FIELD cell aggregates, stored at each occupied cell's first sorted slot
+    float    cell_pos_x_[kPadded];
+    float    cell_pos_y_[kPadded];
+    float    cell_pos_z_[kPadded];
+    float    cell_vel_x_[kPadded];
+    float    cell_vel_y_[kPadded];
+    float    cell_vel_z_[kPadded];
+
+    // Verlet pair list (CSR): boid i's partners j > i are
+    // verlet_pairs_[verlet_start_[i] .. verlet_start_[i + 1]). ref_pos_* hold each
+    // boid's position at the last build, for the drift check.
+    static constexpr size_t kVerletPairs = Capacity * VERLET_PAIRS_PER_BOID;
+    bool     verlet_valid_;
+    float    verlet_cutoff_;   // cutoff of the last build, successful or not
+    uint16_t verlet_backoff_;  // PAIRWISE ticks left before retrying an overflowed build
+    uint16_t verlet_start_[kPadded + 1];
+    uint16_t verlet_pairs_[kVerletPairs];
+    float    ref_pos_x_[kPadded];
+    float    ref_pos_y_[kPadded];
+    float    ref_pos_z_[kPadded];
+
+    StatsClock stats_clock_;
+    FlockStats stats_;
+
+    // Analytics cache, valid while analytics_.version == state_version_. The version is
+    // bumped by every step and by Init / SetNumBoids / Scatter.
+    mutable FlockAnalytics analytics_;
+    uint32_t state_version_;
+
     size_t num_boids_;
     bool initialized_;
 
-    // Simple random number generator (LCG)
+    // Simple random number generator (LCG) for spawning and scattering
     uint32_t rng_state_;
     float Random01();
 };
 
+extern template class BoidsFlock<MAX_BOIDS>;
+
 } // namespace murmur
 
 #endif // BOIDS_H
@@ -0,0 +1,345 @@
+#include "fixed_flock.h"
+
+namespace murmur {
+
+namespace {
+
+// Constants of boids.h in Q24, folded at compile time
+constexpr q24_t MARGIN_XY_Q     = FloatToQ24(BOUNDARY_MARGIN_XY);
+constexpr q24_t MARGIN_Z_LO_Q   = FloatToQ24(BOUNDARY_MARGIN_Z_LO);
+constexpr q24_t MARGIN_Z_HI_Q   = FloatToQ24(BOUNDARY_MARGIN_Z_HI);
+constexpr q24_t INV_MARGIN_XY_Q   = FloatToQ24(1.0f / BOUNDARY_MARGIN_XY);
+constexpr q24_t INV_MARGIN_Z_LO_Q = FloatToQ24(1.0f / BOUNDARY_MARGIN_Z_LO);
+constexpr q24_t INV_MARGIN_Z_HI_Q = FloatToQ24(1.0f / BOUNDARY_MARGIN_Z_HI);
+constexpr q24_t FORCE_XY_Q      = FloatToQ24(BOUNDARY_FORCE_XY);
+constexpr q24_t FORCE_Z_Q       = FloatToQ24(BOUNDARY_FORCE_Z);
+constexpr q24_t WANDER_STRENGTH_Q = FloatToQ24(WANDER_STRENGTH);
+
+// Wander turn rate in 16-bit phase units (65536 = 2pi)
+constexpr int32_t WANDER_TURN_PHASE =
+    static_cast<int32_t>(WANDER_TURN_RATE * (65536.0f / 6.2831853f) + 0.5f);
+
+// Same coincident-boid cutoff as the float engine (dist^2 < 1e-8), in Q48
+constexpr int64_t MIN_DIST_SQ_Q48 = 2814750;
+
+// Fixed step in whole microseconds for the integer accumulator
+constexpr uint32_t STEP_US = static_cast<uint32_t>(FLOCK_FIXED_DT * 1000000.0f + 0.5f);
+
+// Quadratic boundary push: strength * t^2 with t = depth / margin
+inline q24_t BoundaryPush(q24_t depth, q24_t inv_margin, q24_t strength) {
+    const q24_t t = MulQ24(depth, inv_margin);
+    return MulQ24(strength, MulQ24(t, t));
+}
+
+inline q24_t ClampUnit(q24_t v) {
+    return v < 0 ? 0 : (v > Q24_ONE ? Q24_ONE : v);
+}
+
+} // namespace
+
+template <size_t Capacity>
+uint32_t FixedFlock<Capacity>::Random15() {
+    // Same LCG as BoidsFlock, kept in integers end to end
+    rng_state_ = rng_state_ * 1103515245 + 12345;
+    return (rng_state_ >> 16) & 0x7FFF;
+}
+
+template <size_t Capacity>
+q24_t FixedFlock<Capacity>::RandomInRange(q24_t lo, q24_t span) {
+    return lo + static_cast<q24_t>((static_cast<int64_t>(Random15()) * span) / 32767);
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::InitBoid(size_t i) {
+    // Random position inside safe zone (within margins); z starts in 0.3-0.7 range
+    pos_x_[i] = RandomInRange(MARGIN_XY_Q, Q24_ONE - 2 * MARGIN_XY_Q);
+    pos_y_[i] = RandomInRange(MARGIN_XY_Q, Q24_ONE - 2 * MARGIN_XY_Q);
+    pos_z_[i] = RandomInRange(FloatToQ24(0.3f), FloatToQ24(0.4f));
+    vel_x_[i] = RandomInRange(FloatToQ24(-0.01f), FloatToQ24(0.02f));
+    vel_y_[i] = RandomInRange(FloatToQ24(-0.01f), FloatToQ24(0.02f));
+    vel_z_[i] = RandomInRange(FloatToQ24(-0.005f), FloatToQ24(0.01f));  // Slower z movement
+    wander_phase_[i] = static_cast<uint16_t>(Random15() << 1);
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::SnapPrevious(size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) {
+        prev_pos_x_[i] = pos_x_[i];
+        prev_pos_y_[i] = pos_y_[i];
+        prev_pos_z_[i] = pos_z_[i];
+    }
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::Init(size_t num_boids) {
+    rng_state_ = 12345;  // Seed
+
+    num_boids_ = (num_boids > Capacity) ? Capacity : num_boids;
+
+    for (size_t i = 0; i < num_boids_; i++) {
+        InitBoid(i);
+    }
+    SnapPrevious(0, num_boids_);
+    accumulator_us_ = 0;
+    alpha_          = 0.0f;
+    state_version_++;
+
+    initialized_ = true;
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::SetNumBoids(size_t num) {
+    size_t new_num = (num > Capacity) ? Capacity : num;
+
+    // Initialize any new boids inside safe zone
+    for (size_t i = num_boids_; i < new_num; i++) {
+        InitBoid(i);
+    }
+    if (new_num > num_boids_) SnapPrevious(num_boids_, new_num);
+    num_boids_ = new_num;
+    state_version_++;
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::SetBoidState(size_t index, const Vec3& pos, const Vec3& vel) {
+    if (index >= num_boids_) return;
+    pos_x_[index] = FloatToQ24(pos.x);
+    pos_y_[index] = FloatToQ24(pos.y);
+    pos_z_[index] = FloatToQ24(pos.z);
+    vel_x_[index] = FloatToQ24(vel.x);
+    vel_y_[index] = FloatToQ24(vel.y);
+    vel_z_[index] = FloatToQ24(vel.z);
+    SnapPrevious(index, index + 1);
+    state_version_++;
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::Scatter() {
+    for (size_t i = 0; i < num_boids_; i++) {
+        pos_x_[i] = RandomInRange(MARGIN_XY_Q, Q24_ONE - 2 * MARGIN_XY_Q);
+        pos_y_[i] = RandomInRange(MARGIN_XY_Q, Q24_ONE - 2 * MARGIN_XY_Q);
+        pos_z_[i] = RandomInRange(MARGIN_Z_LO_Q, Q24_ONE - MARGIN_Z_LO_Q - MARGIN_Z_HI_Q);
+        vel_x_[i] = RandomInRange(FloatToQ24(-0.025f), FloatToQ24(0.05f));
+        vel_y_[i] = RandomInRange(FloatToQ24(-0.025f), FloatToQ24(0.05f));
+        vel_z_[i] = RandomInRange(FloatToQ24(-0.01f), FloatToQ24(0.02f));
+    }
+    SnapPrevious(0, num_boids_);
+    state_version_++;
+}
+
+template <size_t Capacity>
+Boid FixedFlock<Capacity>::GetBoid(size_t index) const {
+    Boid boid;
+    boid.position     = GetPosition(index);
+    boid.velocity     = GetVelocity(index);
+    boid.acceleration = Vec3(0.0f, 0.0f, 0.0f);  // forces are not kept between steps
+    boid.wander_angle = static_cast<float>(wander_phase_[index]) * (6.2831853f / 65536.0f);
+    return boid;
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::SumNeighbors(const ParamsQ24& p) {
+    for (size_t i = 0; i < num_boids_; i++) {
+        sep_x_[i] = 0; sep_y_[i] = 0; sep_z_[i] = 0;
+        ali_x_[i] = 0; ali_y_[i] = 0; ali_z_[i] = 0;
+        coh_x_[i] = 0; coh_y_[i] = 0; coh_z_[i] = 0;
+        count_[i] = 0;
+    }
+
+    stats_.pair_tests += static_cast<uint32_t>(num_boids_ * (num_boids_ - 1) / 2);
+
+    for (size_t i = 0; i < num_boids_; i++) {
+        const q24_t px = pos_x_[i];
+        const q24_t py = pos_y_[i];
+        const q24_t pz = pos_z_[i];
+
+        for (size_t j = i + 1; j < num_boids_; j++) {
+            // Positions are clamped to [0, 1], so each difference fits in Q24 and the
+            // squared distance (Q48) in int64 without overflow
+            const int64_t dx = px - pos_x_[j];
+            const int64_t dy = py - pos_y_[j];
+            const int64_t dz = pz - pos_z_[j];
+            const int64_t dist_sq = dx * dx + dy * dy + dz * dz;
+            if (dist_sq >= p.radius_sq || dist_sq < MIN_DIST_SQ_Q48) continue;
+
+            // diff / dist^2 as (diff / dist) / dist: inv_dist is 1 / dist in Q15, and
+            // dist_sq < radius^2 <= 1 keeps the Q32 argument inside 32 bits
+            const int64_t inv_dist = IntInvSqrt(static_cast<uint32_t>(dist_sq >> 16));
+            const int64_t sx = (((dx * inv_dist) >> 15) * inv_dist) >> 15;
+            const int64_t sy = (((dy * inv_dist) >> 15) * inv_dist) >> 15;
+            const int64_t sz = (((dz * inv_dist) >> 15) * inv_dist) >> 15;
+            sep_x_[i] += sx; sep_y_[i] += sy; sep_z_[i] += sz;
+            sep_x_[j] -= sx; sep_y_[j] -= sy; sep_z_[j] -= sz;
+
+            ali_x_[i] += vel_x_[j]; ali_y_[i] += vel_y_[j]; ali_z_[i] += vel_z_[j];
+            ali_x_[j] += vel_x_[i]; ali_y_[j] += vel_y_[i]; ali_z_[j] += vel_z_[i];
+
+            coh_x_[i] += pos_x_[j]; coh_y_[i] += pos_y_[j]; coh_z_[i] += pos_z_[j];
+            coh_x_[j] += px;        coh_y_[j] += py;        coh_z_[j] += pz;
+
+            count_[i]++;
+            count_[j]++;
+        }
+    }
+}
+
+template <size_t Capacity>
+Vec3Q24 FixedFlock<Capacity>::SteerFromNeighbors(size_t i, const ParamsQ24& p) const {
+    Vec3Q24 force = {0, 0, 0};
+    const int32_t count = count_[i];
+    if (count == 0) return force;
+
+    const q24_t vx = vel_x_[i];
+    const q24_t vy = vel_y_[i];
+    const q24_t vz = vel_z_[i];
+
+    // Every desired velocity is rescaled to max_speed, so only its direction matters:
+    // the sums are used directly and no per-boid divide by count is needed.
+
+    // Separation steering
+    if (sep_x_[i] != 0 || sep_y_[i] != 0 || sep_z_[i] != 0) {
+        Vec3Q24 sep = SetLengthQ24(sep_x_[i], sep_y_[i], sep_z_[i], p.max_speed);
+        sep = {sep.x - vx, sep.y - vy, sep.z - vz};
+        sep = LimitQ24(sep, p.max_force);
+        force.x += MulQ24(sep.x, p.separation_weight);
+        force.y += MulQ24(sep.y, p.separation_weight);
+        force.z += MulQ24(sep.z, p.separation_weight);
+    }
+
+    // Alignment steering
+    Vec3Q24 ali = SetLengthQ24(ali_x_[i], ali_y_[i], ali_z_[i], p.max_speed);
+    ali = {ali.x - vx, ali.y - vy, ali.z - vz};
+    ali = LimitQ24(ali, p.max_force);
+    force.x += MulQ24(ali.x, p.alignment_weight);
+    force.y += MulQ24(ali.y, p.alignment_weight);
+    force.z += MulQ24(ali.z, p.alignment_weight);
+
+    // Cohesion steering: centroid - pos, scaled by count
+    Vec3Q24 coh = SetLengthQ24(coh_x_[i] - static_cast<int64_t>(pos_x_[i]) * count,
+                               coh_y_[i] - static_cast<int64_t>(pos_y_[i]) * count,
+                               coh_z_[i] - static_cast<int64_t>(pos_z_[i]) * count,
+                               p.max_speed);
+    coh = {coh.x - vx, coh.y - vy, coh.z - vz};
+    coh = LimitQ24(coh, p.max_force);
+    force.x += MulQ24(coh.x, p.cohesion_weight);
+    force.y += MulQ24(coh.y, p.cohesion_weight);
+    force.z += MulQ24(coh.z, p.cohesion_weight);
+
+    return force;
+}
+
+template <size_t Capacity>
+Vec3Q24 FixedFlock<Capacity>::ComputeBoundaryForce(q24_t x, q24_t y, q24_t z) {
+    Vec3Q24 force = {0, 0, 0};
+
+    // X axis (symmetric margins)
+    if (x < MARGIN_XY_Q) {
+        force.x = BoundaryPush(MARGIN_XY_Q - x, INV_MARGIN_XY_Q, FORCE_XY_Q);
+    } else if (x > Q24_ONE - MARGIN_XY_Q) {
+        force.x = -BoundaryPush(x - (Q24_ONE - MARGIN_XY_Q), INV_MARGIN_XY_Q, FORCE_XY_Q);
+    }
+
+    // Y axis (symmetric margins)
+    if (y < MARGIN_XY_Q) {
+        force.y = BoundaryPush(MARGIN_XY_Q - y, INV_MARGIN_XY_Q, FORCE_XY_Q);
+    } else if (y > Q24_ONE - MARGIN_XY_Q) {
+        force.y = -BoundaryPush(y - (Q24_ONE - MARGIN_XY_Q), INV_MARGIN_XY_Q, FORCE_XY_Q);
+    }
+
+    // Z axis (asymmetric margins)
+    if (z < MARGIN_Z_LO_Q) {
+        force.z = BoundaryPush(MARGIN_Z_LO_Q - z, INV_MARGIN_Z_LO_Q, FORCE_Z_Q);
+    } else if (z > Q24_ONE - MARGIN_Z_HI_Q) {
+        force.z = -BoundaryPush(z - (Q24_ONE - MARGIN_Z_HI_Q), INV_MARGIN_Z_HI_Q, FORCE_Z_Q);
+    }
+
+    return force;
+}
+
+template <size_t Capacity>
+void FixedFlock<Capacity>::Update(float dt, const BoidsParams& params) {
+    if (!initialized_ || num_boids_ == 0) return;
+
+    stats_.ticks++;
+    state_version_++;
+
+    // Params change at control rate; convert once per step
+    float radius = params.perception_radius;
+    if (radius < 0.0f) radius = 0.0f;
+    if (radius > 1.0f) radius = 1.0f;
+    const int64_t radius_q = FloatToQ24(radius);
+
+    ParamsQ24 p;
+    p.separation_weight = FloatToQ24(params.separation_weight);
+    p.alignment_weight  = FloatToQ24(params.alignment_weight);
+    p.cohesion_weight   = FloatToQ24(params.cohesion_weight);
+    p.radius_sq         = radius_q * radius_q;
+    p.max_speed         = FloatToQ24(params.max_speed);
+    p.max_force         = FloatToQ24(params.max_force);
+    const q24_t dt_q    = FloatToQ24(dt);
+
+    SumNeighbors(p);
+
+    // Forces are applied immediately: all neighbor sums were taken before any boid moved
+    for (size_t i = 0; i < num_boids_; i++) {
+        Vec3Q24 force = SteerFromNeighbors(i, p);
+        const Vec3Q24 bound = ComputeBoundaryForce(pos_x_[i], pos_y_[i], pos_z_[i]);
+        force.x += bound.x;
+        force.y += bound.y;
+        force.z += bound.z;
+
+        // Wander: random walk of a 16-bit phase (uint16 wraps at 2pi), polynomial sin/cos
+        const int32_t turn = ((static_cast<int32_t>(Random15()) * WANDER_TURN_PHASE) >> 15)
+                           - WANDER_TURN_PHASE / 2;
+        wander_phase_[i] = static_cast<uint16_t>(wander_phase_[i] + turn);
+        force.x += MulQ24(CosQ24(wander_phase_[i]), WANDER_STRENGTH_Q);
+        force.y += MulQ24(SinQ24(wander_phase_[i]), WANDER_STRENGTH_Q);
+
+        // Update physics
+        Vec3Q24 vel = {vel_x_[i] + MulQ24(force.x, dt_q),
+                       vel_y_[i] + MulQ24(force.y, dt_q),
+                       vel_z_[i] + MulQ24(force.z, dt_q)};
+        vel = LimitQ24(vel, p.max_speed);
+
+        // Hard clamp to [0, 1]; integer state has no non-finite case to guard
+        vel_x_[i] = vel.x;
+        vel_y_[i] = vel.y;
+        vel_z_[i] = vel.z;
+        pos_x_[i] = ClampUnit(pos_x_[i] + MulQ24(vel.x, dt_q));
+        pos_y_[i] = ClampUnit(pos_y_[i] + MulQ24(vel.y, dt_q));
+        pos_z_[i] = ClampUnit(pos_z_[i] + MulQ24(vel.z, dt_q));
+    }
+}
+
+template <size_t Capacity>
+size_t FixedFlock<Capacity>::Advance(float elapsed, const BoidsParams& params,
+                                     size_t max_steps) {
+    if (!initialized_) return 0;
+    if (max_steps > FLOCK_MAX_SUBSTEPS) max_steps = FLOCK_MAX_SUBSTEPS;
+    if (elapsed > 0.0f) {
+        accumulator_us_ += static_cast<uint32_t>(elapsed * 1000000.0f + 0.5f);
+    }
+    stats_.step_interval_us = STEP_US;  // params.adaptive_step is not supported here
+
+    size_t steps = 0;
+    while (accumulator_us_ >= STEP_US && steps < max_steps) {
+        SnapPrevious(0, num_boids_);
+        Update(FLOCK_FIXED_DT, params);
+        accumulator_us_ -= STEP_US;
+        steps++;
+    }
+
+    // Drop whole steps beyond the cap and keep only the fractional remainder
+    if (accumulator_us_ >= STEP_US) {
+        stats_.dropped_steps += accumulator_us_ / STEP_US;
+        accumulator_us_ %= STEP_US;
+    }
+
+    alpha_ = static_cast<float>(accumulator_us_) / static_cast<float>(STEP_US);
+    return steps;
+}
+
+// Capacities built into this binary
+template class FixedFlock<MAX_BOIDS>;
+
+} // namespace murmur
@@ -0,0 +1,135 @@
+#pragma once
+#ifndef FIXED_FLOCK_H
+#define FIXED_FLOCK_H
+
+#include "boids.h"
+#include "fixed_math.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace murmur {
+
+// Fixed-point flock backend. Same public interface and BoidsParams as BoidsFlock, but
+// positions, velocities and forces are Q8.24 integers: distance tests, normalization
+// (IntInvSqrt) and wander (polynomial sine) never touch the FPU. Given the same params
+// and step sequence it produces bit-identical flights on the host and on the Daisy,
+// and positions cannot become NaN/Inf.
+//
+// Neighbor search is always the symmetric pairwise scan (params.neighbor_search is
+// ignored); perception_radius is clamped to 1 so squared distances fit 32 bits.
+// Member definitions live in fixed_flock.cpp, instantiated for MAX_BOIDS.
+template <size_t Capacity>
+class FixedFlock {
+public:
+    static constexpr size_t kCapacity = Capacity;
+
+    FixedFlock()
+        : accumulator_us_(0), alpha_(0.0f), stats_(), analytics_(), state_version_(0),
+          num_boids_(0), initialized_(false) {}
+    ~FixedFlock() {}
+
+    void Init(size_t num_boids);
+    // Single integration step of length dt (converted to Q24 once per call)
+    void Update(float dt, const BoidsParams& params);
+    // Fixed-step driver, same contract as BoidsFlock::Advance(); time is kept in integer
+    // microseconds so the step count never depends on float round-off.
+    size_t Advance(float elapsed, const BoidsParams& params,
+                   size_t max_steps = FLOCK_MAX_SUBSTEPS);
+    void Scatter();  // Randomize positions
+
+    void SetNumBoids(size_t num);
+    // Trace replay, same contract as BoidsFlock::SetBoidState()
+    void SetBoidState(size_t index, const Vec3& pos, const Vec3& vel);
+    size_t GetNumBoids() const { return num_boids_; }
+    Boid GetBoid(size_t index) const;
+    Vec3 GetPosition(size_t index) const {
+        return Vec3(Q24ToFloat(pos_x_[index]), Q24ToFloat(pos_y_[index]),
+                    Q24ToFloat(pos_z_[index]));
+    }
+    Vec3 GetVelocity(size_t index) const {
+        return Vec3(Q24ToFloat(vel_x_[index]), Q24ToFloat(vel_y_[index]),
+                    Q24ToFloat(vel_z_[index]));
+    }
+    // Blend between the last two fixed steps; only the output side uses float
+    Vec3 GetInterpolatedPosition(size_t index) const {
+        const Vec3 prev(Q24ToFloat(prev_pos_x_[index]), Q24ToFloat(prev_pos_y_[index]),
+                        Q24ToFloat(prev_pos_z_[index]));
+        return prev + (GetPosition(index) - prev) * alpha_;
+    }
+    // Same contract as BoidsFlock::GetStateAge()
+    float GetStateAge() const { return static_cast<float>(accumulator_us_) * 0.000001f; }
+
+    const FlockStats& GetStats() const { return stats_; }
+    void ResetStats() { stats_ = FlockStats(); }
+
+    // Same cached analytics as BoidsFlock::GetAnalytics()
+    const FlockAnalytics& GetAnalytics() const {
+        if (analytics_.version != state_version_) {
+            ComputeFlockAnalytics(*this, analytics_);
+            analytics_.version = state_version_;
+        }
+        return analytics_;
+    }
+    int GetCellDensity(size_t grid_x, size_t grid_y) const {
+        if (grid_x >= LED_GRID_DIM || grid_y >= LED_GRID_DIM) return 0;
+        return GetAnalytics().density[grid_x][grid_y];
+    }
+
+private:
+    // Params converted to Q24 once per step
+    struct ParamsQ24 {
+        q24_t   separation_weight;
+        q24_t   alignment_weight;
+        q24_t   cohesion_weight;
+        int64_t radius_sq;  // Q48
+        q24_t   max_speed;
+        q24_t   max_force;
+    };
+
+    void InitBoid(size_t index);
+    void SnapPrevious(size_t from, size_t to);
+    void SumNeighbors(const ParamsQ24& p);
+    Vec3Q24 SteerFromNeighbors(size_t index, const ParamsQ24& p) const;
+    static Vec3Q24 ComputeBoundaryForce(q24_t x, q24_t y, q24_t z);
+    q24_t RandomInRange(q24_t lo, q24_t span);  // lo + [0, 1] * span
+    uint32_t Random15();                        // 15 random bits from the LCG
+
+    q24_t pos_x_[Capacity];
+    q24_t pos_y_[Capacity];
+    q24_t pos_z_[Capacity];
+    q24_t vel_x_[Capacity];
+    q24_t vel_y_[Capacity];
+    q24_t vel_z_[Capacity];
+    q24_t prev_pos_x_[Capacity];
+    q24_t prev_pos_y_[Capacity];
+    q24_t prev_pos_z_[Capacity];
+    uint16_t wander_phase_[Capacity];  // 65536 = 2pi
+
+    // Neighbor accumulators. Separation sums diff / dist^2 and can reach ~2^40 in Q24.
+    int64_t sep_x_[Capacity];
+    int64_t sep_y_[Capacity];
+    int64_t sep_z_[Capacity];
+    int64_t ali_x_[Capacity];
+    int64_t ali_y_[Capacity];
+    int64_t ali_z_[Capacity];
+    int64_t coh_x_[Capacity];
+    int64_t coh_y_[Capacity];
+    int64_t coh_z_[Capacity];
+    int32_t count_[Capacity];
+
+    uint32_t accumulator_us_;
+    float    alpha_;
+    FlockStats stats_;
+    mutable FlockAnalytics analytics_;
+    uint32_t state_version_;  // bumped by every step and by Init / SetNumBoids / Scatter
+
+    size_t num_boids_;
+    bool initialized_;
+    uint32_t rng_state_;
+};
+
+extern template class FixedFlock<MAX_BOIDS>;
+
+} // namespace murmur
+
+#endif // FIXED_FLOCK_H
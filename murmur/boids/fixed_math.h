@@ -0,0 +1,125 @@
+#pragma once
+#ifndef FIXED_MATH_H
+#define FIXED_MATH_H
+
+#include <cstdint>
+
+namespace murmur {
+
+// Q8.24 signed fixed point: 1.0 = 1 << 24, range +-128, resolution ~6e-8.
+// 24 fraction bits keep a 2 ms velocity increment (a * dt ~ 1e-5) well above one LSB.
+// Products are formed in int64 and shifted back; right shifts of negative values are
+// arithmetic on every compiler we target (GCC on ARM and x86), so results are bit-exact.
+using q24_t = int32_t;
+constexpr int   Q24_BITS = 24;
+constexpr q24_t Q24_ONE  = 1 << Q24_BITS;
+
+constexpr q24_t FloatToQ24(float f) {
+    return static_cast<q24_t>(f * static_cast<float>(Q24_ONE));
+}
+
+inline float Q24ToFloat(q24_t q) {
+    return static_cast<float>(q) * (1.0f / static_cast<float>(Q24_ONE));
+}
+
+constexpr q24_t MulQ24(q24_t a, q24_t b) {
+    return static_cast<q24_t>((static_cast<int64_t>(a) * b) >> Q24_BITS);
+}
+
+// floor(sqrt(x)), computed bit by bit: exact and identical on every target
+inline uint32_t IntSqrt(uint32_t x) {
+    uint32_t res = 0;
+    if (x == 0) return 0;
+    // Highest even power of two <= x (CLZ is one instruction on the Cortex-M7)
+    uint32_t bit = 1u << ((31 - __builtin_clz(x)) & ~1);
+    while (bit != 0) {
+        if (x >= res + bit) {
+            x  -= res + bit;
+            res = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+    return res;
+}
+
+// Integer reciprocal square root: 2^31 / sqrt(x), or 0 for x == 0.
+// One IntSqrt plus one 32-bit hardware divide.
+inline uint32_t IntInvSqrt(uint32_t x) {
+    uint32_t root = IntSqrt(x);
+    return root ? 0x80000000u / root : 0;
+}
+
+struct Vec3Q24 {
+    q24_t x;
+    q24_t y;
+    q24_t z;
+};
+
+// Rescales (x, y, z) to the given Q24 length; zero vectors stay zero.
+// Components may be any scale: they are shifted together to 15 significant bits first
+// (direction kept to ~3e-5), so the squared length fits 32 bits for IntInvSqrt.
+inline Vec3Q24 SetLengthQ24(int64_t x, int64_t y, int64_t z, q24_t length) {
+    Vec3Q24 out = {0, 0, 0};
+    int64_t ax = x < 0 ? -x : x;
+    int64_t ay = y < 0 ? -y : y;
+    int64_t az = z < 0 ? -z : z;
+    int64_t m  = ax > ay ? (ax > az ? ax : az) : (ay > az ? ay : az);
+    if (m == 0) return out;
+
+    const int msb = 63 - __builtin_clzll(static_cast<uint64_t>(m));
+    if (msb > 14) {
+        x >>= msb - 14; y >>= msb - 14; z >>= msb - 14;
+    } else {
+        const int64_t scale = int64_t(1) << (14 - msb);
+        x *= scale; y *= scale; z *= scale;
+    }
+
+    const int32_t a = static_cast<int32_t>(x);
+    const int32_t b = static_cast<int32_t>(y);
+    const int32_t c = static_cast<int32_t>(z);
+    uint32_t len_sq = static_cast<uint32_t>(a * a) + static_cast<uint32_t>(b * b)
+                    + static_cast<uint32_t>(c * c);
+    int64_t inv = IntInvSqrt(len_sq);  // 2^31 / |v|
+
+    // a * inv is a / |v| in Q31; >> 7 gives the unit component in Q24
+    out.x = MulQ24(static_cast<q24_t>((a * inv) >> 7), length);
+    out.y = MulQ24(static_cast<q24_t>((b * inv) >> 7), length);
+    out.z = MulQ24(static_cast<q24_t>((c * inv) >> 7), length);
+    return out;
+}
+
+// Clamps v to at most max_len (Q24), leaving shorter vectors untouched
+inline Vec3Q24 LimitQ24(const Vec3Q24& v, q24_t max_len) {
+    int64_t len_sq = static_cast<int64_t>(v.x) * v.x + static_cast<int64_t>(v.y) * v.y
+                   + static_cast<int64_t>(v.z) * v.z;
+    int64_t max_sq = static_cast<int64_t>(max_len) * max_len;
+    if (len_sq <= max_sq) return v;
+    return SetLengthQ24(v.x, v.y, v.z, max_len);
+}
+
+// sin() of a 16-bit phase (65536 = 2pi) in Q24. Odd 5th-order polynomial per quadrant,
+// with the last coefficient fitted so sin(pi/2) is exactly 1 (max error ~0.1%).
+inline q24_t SinQ24(uint16_t phase) {
+    constexpr q24_t A = 26353589;  // 1.5707963 (pi/2)
+    constexpr q24_t B = 10837479;  // 0.6459640 ((pi/2)^3 / 6)
+    constexpr q24_t C = 1261106;   // 0.0751677 (1 - A + B)
+
+    const uint32_t quadrant = phase >> 14;
+    uint32_t frac = phase & 0x3FFFu;
+    if (quadrant & 1u) frac = 0x4000u - frac;  // mirror on the falling quarter
+
+    const q24_t t  = static_cast<q24_t>(frac << 10);  // Q14 -> Q24, t in [0, 1]
+    const q24_t t2 = MulQ24(t, t);
+    q24_t s = MulQ24(t, A - MulQ24(t2, B - MulQ24(t2, C)));
+    return (quadrant & 2u) ? -s : s;
+}
+
+inline q24_t CosQ24(uint16_t phase) {
+    return SinQ24(static_cast<uint16_t>(phase + 0x4000u));
+}
+
+} // namespace murmur
+
+#endif // FIXED_MATH_H
@@ -0,0 +1,20 @@
+#pragma once
+#ifndef FLOCK_H
+#define FLOCK_H
+
+#include "boids.h"
+#include "fixed_flock.h"
+
+namespace murmur {
+
+// The flock type used by the firmware (simulation, UI and voice mapping).
+// Build with -DMURMUR_FIXED_POINT (make fixed) for the deterministic integer backend.
+#ifdef MURMUR_FIXED_POINT
+using Flock = FixedFlock<MAX_BOIDS>;
+#else
+using Flock = BoidsFlock<MAX_BOIDS>;
+#endif
+
+} // namespace murmur
+
+#endif // FLOCK_H
@@ -0,0 +1,79 @@
+#pragma once
+#ifndef FLOCK_ANALYTICS_H
+#define FLOCK_ANALYTICS_H
+
+#include "vec3.h"
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+namespace murmur {
+
+constexpr size_t LED_GRID_DIM = 4;  // 4x4 LED grid for density visualization
+
+// Whole-flock summary, computed in one pass over the boids and cached by the flock
+// until its state changes (see GetAnalytics()).
+struct FlockAnalytics {
+    uint32_t version;       // flock state version these values were computed from
+    uint16_t density[LED_GRID_DIM][LED_GRID_DIM];  // boids per x-y cell, [x][y]
+    Vec3  centroid;         // mean position
+    float spread;           // RMS distance from the centroid
+    float mean_speed;       // mean |velocity|
+    float polarization;     // |mean heading|: 0 = disordered, 1 = all flying the same way
+};
+
+// Single pass: histogram plus first and second moments. Spread uses
+// E[|p|^2] - |E[p]|^2 so it needs no second sweep over the positions.
+template <class FlockT>
+void ComputeFlockAnalytics(const FlockT& flock, FlockAnalytics& out) {
+    for (size_t x = 0; x < LED_GRID_DIM; x++) {
+        for (size_t y = 0; y < LED_GRID_DIM; y++) {
+            out.density[x][y] = 0;
+        }
+    }
+
+    const size_t n = flock.GetNumBoids();
+    Vec3  sum_pos, sum_heading;
+    float sum_pos_sq = 0.0f;
+    float sum_speed  = 0.0f;
+
+    for (size_t i = 0; i < n; i++) {
+        const Vec3 pos = flock.GetPosition(i);
+        const Vec3 vel = flock.GetVelocity(i);
+
+        int gx = static_cast<int>(pos.x * LED_GRID_DIM);
+        int gy = static_cast<int>(pos.y * LED_GRID_DIM);
+        // Clamp to valid range
+        if (gx < 0) gx = 0;
+        if (gx >= static_cast<int>(LED_GRID_DIM)) gx = static_cast<int>(LED_GRID_DIM) - 1;
+        if (gy < 0) gy = 0;
+        if (gy >= static_cast<int>(LED_GRID_DIM)) gy = static_cast<int>(LED_GRID_DIM) - 1;
+        out.density[gx][gy]++;
+
+        sum_pos    += pos;
+        sum_pos_sq += pos.MagnitudeSquared();
+
+        const float speed = vel.Magnitude();
+        sum_speed += speed;
+        if (speed > 0.0f) sum_heading += vel * (1.0f / speed);
+    }
+
+    if (n == 0) {
+        out.centroid     = Vec3(0.0f, 0.0f, 0.0f);
+        out.spread       = 0.0f;
+        out.mean_speed   = 0.0f;
+        out.polarization = 0.0f;
+        return;
+    }
+
+    const float inv_n = 1.0f / static_cast<float>(n);
+    out.centroid   = sum_pos * inv_n;
+    float var      = sum_pos_sq * inv_n - out.centroid.MagnitudeSquared();
+    out.spread     = (var > 0.0f) ? sqrtf(var) : 0.0f;
+    out.mean_speed = sum_speed * inv_n;
+    out.polarization = sum_heading.Magnitude() * inv_n;
+}
+
+} // namespace murmur
+
+#endif // FLOCK_ANALYTICS_H
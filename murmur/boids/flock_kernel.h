@@ -0,0 +1,293 @@
+#pragma once
+#ifndef FLOCK_KERNEL_H
+#define FLOCK_KERNEL_H
+
+#include "boids.h"
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+
+namespace murmur {
+
+// Per-lane flock code shared by BoidsFlock and MultiFlock: spawning, padding, the
+// all-pairs and symmetric-pair neighbor kernels, wander, integration and the fixed-step
+// driver.
+//
+// Both classes keep the same structure-of-arrays members (pos_x_, vel_x_, sep_x_, ...);
+// they differ only in which lanes make up a flock. Each helper takes the owning object
+// and a lane range, and reads the member arrays directly, so the compiler still sees
+// distinct arrays and vectorizes the kernel as it would inside the class. The classes
+// declare FlockKernel a friend.
+struct FlockKernel {
+    // Linear congruential generator on f.rng_state_ (spawning and scattering)
+    template <class F>
+    static float Random01(F& f) {
+        f.rng_state_ = f.rng_state_ * 1103515245 + 12345;
+        return static_cast<float>((f.rng_state_ >> 16) & 0x7FFF) / 32767.0f;
+    }
+
+    // New boid in lane i, inside the safe zone (z starts in 0.3-0.7), with a random wander
+    // direction and its own wander stream
+    template <class F>
+    static void SpawnBoid(F& f, size_t i) {
+        f.pos_x_[i] = BOUNDARY_MARGIN_XY + Random01(f) * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        f.pos_y_[i] = BOUNDARY_MARGIN_XY + Random01(f) * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        f.pos_z_[i] = 0.3f + Random01(f) * 0.4f;
+        f.vel_x_[i] = (Random01(f) - 0.5f) * 0.02f;
+        f.vel_y_[i] = (Random01(f) - 0.5f) * 0.02f;
+        f.vel_z_[i] = (Random01(f) - 0.5f) * 0.01f;  // Slower z movement
+        f.acc_x_[i] = 0.0f;
+        f.acc_y_[i] = 0.0f;
+        f.acc_z_[i] = 0.0f;
+
+        float angle = Random01(f) * 6.2832f;  // random start angle 0-2pi
+        f.wander_x_[i] = cosf(angle);
+        f.wander_y_[i] = sinf(angle);
+        // Decorrelate the boids' streams: the LCG state mixed with a per-index odd constant
+        uint32_t seed = f.rng_state_ ^ (static_cast<uint32_t>(i + 1) * 0x9E3779B9u);
+        f.wander_rng_[i] = seed ? seed : 1u;
+    }
+
+    // Moves lanes [from, to) out of range, with no velocity and no wander force
+    template <class F>
+    static void ParkLanes(F& f, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            f.pos_x_[i] = PADDING_POSITION;
+            f.pos_y_[i] = PADDING_POSITION;
+            f.pos_z_[i] = PADDING_POSITION;
+            f.vel_x_[i] = 0.0f;
+            f.vel_y_[i] = 0.0f;
+            f.vel_z_[i] = 0.0f;
+            f.acc_x_[i] = 0.0f;
+            f.acc_y_[i] = 0.0f;
+            f.acc_z_[i] = 0.0f;
+            f.wander_x_[i] = 0.0f;  // zero direction stays zero, so parked lanes get no force
+            f.wander_y_[i] = 0.0f;
+            f.wander_rng_[i] = 1u;
+        }
+    }
+
+    template <class F>
+    static void ClearNeighborSums(F& f, size_t from, size_t to) {
+        for (size_t i = from; i < to; i++) {
+            f.sep_x_[i] = 0.0f; f.sep_y_[i] = 0.0f; f.sep_z_[i] = 0.0f;
+            f.ali_x_[i] = 0.0f; f.ali_y_[i] = 0.0f; f.ali_z_[i] = 0.0f;
+            f.coh_x_[i] = 0.0f; f.coh_y_[i] = 0.0f; f.coh_z_[i] = 0.0f;
+            f.count_[i] = 0.0f;
+        }
+    }
+
+    // Branchless all-pairs pass: every boid j in [lo, lo + num) is a potential neighbor of
+    // every lane i in [lo, hi), the flock's padded lane block. Adds into the (cleared)
+    // neighbor accumulators.
+    template <class F>
+    static void SumAllPairs(F& f, size_t lo, size_t num, size_t hi, float radius_sq) {
+        for (size_t j = lo; j < lo + num; j++) {
+            const float qx = f.pos_x_[j];
+            const float qy = f.pos_y_[j];
+            const float qz = f.pos_z_[j];
+            const float wx = f.vel_x_[j];
+            const float wy = f.vel_y_[j];
+            const float wz = f.vel_z_[j];
+
+            for (size_t i = lo; i < hi; i++) {
+                float dx = f.pos_x_[i] - qx;
+                float dy = f.pos_y_[i] - qy;
+                float dz = f.pos_z_[i] - qz;
+                float dist_sq = dx * dx + dy * dy + dz * dz;
+
+                // Self (dist 0), coincident boids, boids outside the radius and parked
+                // padding lanes all get weight 0. The divisor is bumped by 1 on masked
+                // lanes so no lane ever divides by 0.
+                float mask    = static_cast<float>((dist_sq < radius_sq) & (dist_sq >= 0.00000001f));
+                float inv_dsq = mask / (dist_sq + (1.0f - mask));
+
+                // Separation: diff weighted by inverse squared distance
+                f.sep_x_[i] += dx * inv_dsq;
+                f.sep_y_[i] += dy * inv_dsq;
+                f.sep_z_[i] += dz * inv_dsq;
+                // Alignment: neighbor velocities
+                f.ali_x_[i] += wx * mask;
+                f.ali_y_[i] += wy * mask;
+                f.ali_z_[i] += wz * mask;
+                // Cohesion: neighbor positions
+                f.coh_x_[i] += qx * mask;
+                f.coh_y_[i] += qy * mask;
+                f.coh_z_[i] += qz * mask;
+                f.count_[i] += mask;
+            }
+        }
+    }
+
+    // Partners of boid i for SumSymmetricPairs(): every later boid (PAIRWISE) ...
+    struct LaterBoids {
+        size_t num;
+        size_t Begin(size_t i) const { return i + 1; }
+        size_t End(size_t) const { return num; }
+        size_t operator[](size_t k) const { return k; }
+    };
+    // ... or boid i's cached partners j > i in a CSR pair list (VERLET)
+    struct PairList {
+        const uint16_t* start;
+        const uint16_t* pairs;
+        size_t Begin(size_t i) const { return start[i]; }
+        size_t End(size_t i) const { return start[i + 1]; }
+        size_t operator[](size_t k) const { return pairs[k]; }
+    };
+
+    // Symmetric pass over boids [0, num): each pair (i, j > i) from partners is tested
+    // once, and a pair within the radius adds its terms to both boids. Pairs where both
+    // boids are deferred by the LOD scheduler are skipped. Adds into the (cleared)
+    // neighbor accumulators.
+    template <class F, class Partners>
+    static void SumSymmetricPairs(F& f, size_t num, float radius_sq, const Partners& partners) {
+        for (size_t i = 0; i < num; i++) {
+            const float px = f.pos_x_[i];
+            const float py = f.pos_y_[i];
+            const float pz = f.pos_z_[i];
+            const float vx = f.vel_x_[i];
+            const float vy = f.vel_y_[i];
+            const float vz = f.vel_z_[i];
+
+            // Boid i's side of each pair is summed locally and stored once after the row
+            Vec3  sep, ali, coh;
+            float count = 0.0f;
+            const uint8_t defer_i = f.lod_defer_[i];
+
+            for (size_t k = partners.Begin(i); k < partners.End(i); k++) {
+                const size_t j = partners[k];
+                if (defer_i & f.lod_defer_[j]) continue;  // neither side steers this step
+                float dx = px - f.pos_x_[j];
+                float dy = py - f.pos_y_[j];
+                float dz = pz - f.pos_z_[j];
+                float dist_sq = dx * dx + dy * dy + dz * dz;
+                if (dist_sq >= radius_sq || dist_sq < 0.00000001f) continue;
+
+                // Separation is antisymmetric: j receives the negated diff
+                float inv_dsq = 1.0f / dist_sq;
+                float sx = dx * inv_dsq;
+                float sy = dy * inv_dsq;
+                float sz = dz * inv_dsq;
+                sep += Vec3(sx, sy, sz);
+                f.sep_x_[j] -= sx;
+                f.sep_y_[j] -= sy;
+                f.sep_z_[j] -= sz;
+
+                // Alignment and cohesion: each boid sees the other's velocity / position
+                ali += Vec3(f.vel_x_[j], f.vel_y_[j], f.vel_z_[j]);
+                f.ali_x_[j] += vx;
+                f.ali_y_[j] += vy;
+                f.ali_z_[j] += vz;
+                coh += Vec3(f.pos_x_[j], f.pos_y_[j], f.pos_z_[j]);
+                f.coh_x_[j] += px;
+                f.coh_y_[j] += py;
+                f.coh_z_[j] += pz;
+
+                count += 1.0f;
+                f.count_[j] += 1.0f;
+            }
+
+            f.sep_x_[i] += sep.x; f.sep_y_[i] += sep.y; f.sep_z_[i] += sep.z;
+            f.ali_x_[i] += ali.x; f.ali_y_[i] += ali.y; f.ali_z_[i] += ali.z;
+            f.coh_x_[i] += coh.x; f.coh_y_[i] += coh.y; f.coh_z_[i] += coh.z;
+            f.count_[i] += count;
+        }
+    }
+
+    // Lane i's accumulated neighbor sums, as SteerFromNeighbors() takes them
+    template <class F>
+    static NeighborSums NeighborSumsAt(const F& f, size_t i) {
+        NeighborSums sums;
+        sums.separation = Vec3(f.sep_x_[i], f.sep_y_[i], f.sep_z_[i]);
+        sums.alignment  = Vec3(f.ali_x_[i], f.ali_y_[i], f.ali_z_[i]);
+        sums.cohesion   = Vec3(f.coh_x_[i], f.coh_y_[i], f.coh_z_[i]);
+        sums.count      = f.count_[i];
+        return sums;
+    }
+
+    // Wander: a constant-magnitude x-y force whose direction drifts as a random walk, so
+    // consecutive steps push in similar directions (smooth arcs, not jitter). Runs over
+    // padded lanes too; parked lanes have a zero wander vector and add nothing.
+    template <class F>
+    static void Wander(F& f, size_t from, size_t to, float dt) {
+        const float turn_scale = WanderTurnScale(dt);
+        for (size_t i = from; i < to; i++) {
+            RotateWander(f.wander_rng_[i], f.wander_x_[i], f.wander_y_[i], turn_scale);
+            f.acc_x_[i] += f.wander_x_[i] * WANDER_STRENGTH;
+            f.acc_y_[i] += f.wander_y_[i] * WANDER_STRENGTH;
+        }
+    }
+
+    // Hard clamp to the unit cube as a safety net; non-finite positions reset to the center
+    static void ClampToUnitCube(Vec3& pos) {
+        if (!std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z)) {
+            pos.x = 0.5f;
+            pos.y = 0.5f;
+            pos.z = 0.5f;
+            return;
+        }
+        if (pos.x < 0.0f) pos.x = 0.0f;
+        else if (pos.x > 1.0f) pos.x = 1.0f;
+        if (pos.y < 0.0f) pos.y = 0.0f;
+        else if (pos.y > 1.0f) pos.y = 1.0f;
+        if (pos.z < 0.0f) pos.z = 0.0f;
+        else if (pos.z > 1.0f) pos.z = 1.0f;
+    }
+
+    // Semi-implicit Euler for lane i: the acceleration acts over force_dt (dt, or the
+    // time since a deferred boid last steered), the position moves over dt. Clears acc_.
+    template <class F>
+    static void IntegrateBoid(F& f, size_t i, float force_dt, float dt, float max_speed) {
+        Vec3 vel(f.vel_x_[i] + f.acc_x_[i] * force_dt,
+                 f.vel_y_[i] + f.acc_y_[i] * force_dt,
+                 f.vel_z_[i] + f.acc_z_[i] * force_dt);
+        vel.Limit(max_speed);
+
+        Vec3 pos(f.pos_x_[i] + vel.x * dt,
+                 f.pos_y_[i] + vel.y * dt,
+                 f.pos_z_[i] + vel.z * dt);
+        ClampToUnitCube(pos);
+
+        f.vel_x_[i] = vel.x;
+        f.vel_y_[i] = vel.y;
+        f.vel_z_[i] = vel.z;
+        f.pos_x_[i] = pos.x;
+        f.pos_y_[i] = pos.y;
+        f.pos_z_[i] = pos.z;
+        f.acc_x_[i] = 0.0f;
+        f.acc_y_[i] = 0.0f;
+        f.acc_z_[i] = 0.0f;
+    }
+
+    // Fixed-step driver behind Advance(): calls step() for each whole step of dt in the
+    // accumulator, at most max_steps times. A long stall would otherwise make the next
+    // calls run the cap every time, so whole steps beyond the cap are dropped (added to
+    // dropped) and only the fractional remainder is kept. Returns the steps run.
+    template <class StepFn>
+    static size_t RunFixedSteps(float& accumulator, float dt, size_t max_steps,
+                                uint32_t& dropped, StepFn step) {
+        // Tolerance so float round-off in the running sum (e.g. 3 ms + 1 ms) still
+        // yields the exact step count the millisecond timestamps imply
+        const float step_threshold = dt - 0.000001f;
+
+        size_t steps = 0;
+        while (accumulator >= step_threshold && steps < max_steps) {
+            step();
+            accumulator -= dt;
+            if (accumulator < 0.0f) accumulator = 0.0f;
+            steps++;
+        }
+
+        if (accumulator >= step_threshold) {
+            uint32_t backlog = static_cast<uint32_t>(accumulator / step_threshold);
+            dropped += backlog;
+            accumulator -= static_cast<float>(backlog) * dt;
+            if (accumulator < 0.0f || accumulator >= step_threshold) accumulator = 0.0f;
+        }
+        return steps;
+    }
+};
+
+} // namespace murmur
+
+#endif // FLOCK_KERNEL_H
@@ -0,0 +1,314 @@
+#include "flock_trace.h"
+
+namespace murmur {
+
+namespace {
+
+constexpr uint8_t TRACE_MAGIC[4] = {'M', 'T', 'R', 'C'};
+
+constexpr uint8_t TAG_KEYFRAME = 0;
+constexpr uint8_t TAG_FRAME    = 1;
+constexpr uint8_t TAG_EVENT    = 2;
+
+// Worst-case record sizes: a 17-bit residual is six 3-bit nibbles (3 bytes)
+constexpr size_t KEYFRAME_BYTES_PER_BOID = 12;
+constexpr size_t FRAME_BYTES_PER_BOID    = 6 * 3;
+
+uint32_t ZigZag(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+int32_t UnZigZag(uint32_t z) {
+    return static_cast<int32_t>(z >> 1) ^ -static_cast<int32_t>(z & 1u);
+}
+
+// Time between two frames' simulation states, in TRACE_AGE_UNIT (50 us) units: the wall
+// time between the records, corrected by how far each state lagged its record
+int32_t StateInterval(uint32_t dt_ms, uint8_t prev_age, uint8_t age) {
+    if (dt_ms > 1000) dt_ms = 1000;  // long gaps: prediction is hopeless anyway
+    return static_cast<int32_t>(dt_ms) * 20 - age + prev_age;
+}
+
+// Position prediction shared by writer and reader (integer only, so both sides agree
+// bit for bit): pos + vel * interval. 65535 / (32767 / TRACE_VEL_RANGE) * 50 us = 1 / 5000.
+int32_t PredictPosition(uint16_t pos, int16_t vel, int32_t interval) {
+    int32_t step = static_cast<int32_t>(vel) * interval;
+    step = (step >= 0) ? (step + 2500) / 5000 : (step - 2500) / 5000;
+    int32_t p = static_cast<int32_t>(pos) + step;
+    return p < 0 ? 0 : (p > 65535 ? 65535 : p);
+}
+
+// Velocity prediction: the previous velocity plus the previous frame's change
+int32_t PredictVelocity(int16_t vel, int16_t dvel) {
+    int32_t v = static_cast<int32_t>(vel) + dvel;
+    return v < -32767 ? -32767 : (v > 32767 ? 32767 : v);
+}
+
+int32_t ClampDelta(int32_t d) {
+    return d < -32767 ? -32767 : (d > 32767 ? 32767 : d);
+}
+
+} // namespace
+
+uint16_t TraceWriter::QuantizePosition(float p) {
+    if (!(p > 0.0f)) return 0;
+    if (p >= 1.0f) return 65535;
+    return static_cast<uint16_t>(p * 65535.0f + 0.5f);
+}
+
+int16_t TraceWriter::QuantizeVelocity(float v) {
+    float q = v * (32767.0f / TRACE_VEL_RANGE);
+    if (!(q > -32767.0f)) return -32767;  // also catches NaN
+    if (q >= 32767.0f) return 32767;
+    return static_cast<int16_t>(q >= 0.0f ? q + 0.5f : q - 0.5f);
+}
+
+uint8_t TraceWriter::QuantizeAge(float seconds) {
+    float q = seconds / TRACE_AGE_UNIT + 0.5f;
+    if (!(q > 0.0f)) return 0;
+    return q >= 255.0f ? 255 : static_cast<uint8_t>(q);
+}
+
+void TraceWriter::Init(uint8_t* buffer, size_t capacity) {
+    buffer_   = buffer;
+    capacity_ = capacity;
+    size_     = 0;
+    started_  = false;
+    last_ms_  = 0;
+    last_frame_ms_ = 0;
+    frames_   = 0;
+    since_keyframe_ = 0;
+    prev_.num_boids = 0;
+
+    full_ = (buffer == nullptr || capacity < TRACE_HEADER_BYTES);
+    if (full_) return;
+    for (uint8_t b : TRACE_MAGIC) PutByte(b);
+    PutByte(TRACE_VERSION);
+}
+
+void TraceWriter::PutVarint(uint32_t v) {
+    while (v >= 0x80u) {
+        PutByte(static_cast<uint8_t>(v | 0x80u));
+        v >>= 7;
+    }
+    PutByte(static_cast<uint8_t>(v));
+}
+
+bool TraceWriter::BeginRecord(uint8_t tag, uint32_t now_ms, size_t max_payload) {
+    if (full_) return false;
+    // Tag + worst-case time varint + payload must fit, or the trace ends here
+    if (size_ + 1 + 5 + max_payload > capacity_) {
+        full_ = true;
+        return false;
+    }
+    PutByte(tag);
+    PutVarint(started_ ? now_ms - last_ms_ : 0);
+    started_ = true;
+    last_ms_ = now_ms;
+    return true;
+}
+
+bool TraceWriter::WriteEvent(uint32_t now_ms, const TraceEvent& event) {
+    if (!BeginRecord(TAG_EVENT, now_ms, 2 + 5)) return false;
+    PutByte(static_cast<uint8_t>(event.type));
+    PutByte(event.index);
+    PutVarint(ZigZag(event.value));
+    return true;
+}
+
+bool TraceWriter::CommitFrame(uint32_t now_ms) {
+    const size_t num = next_.num_boids;
+    const bool key = frames_ == 0 || since_keyframe_ >= TRACE_KEYFRAME_INTERVAL
+                  || num != prev_.num_boids;
+
+    if (key) {
+        if (!BeginRecord(TAG_KEYFRAME, now_ms, 2 + num * KEYFRAME_BYTES_PER_BOID)) return false;
+        PutByte(static_cast<uint8_t>(num));
+        PutByte(next_.age);
+        for (size_t i = 0; i < num; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                PutByte(static_cast<uint8_t>(next_.pos[c][i]));
+                PutByte(static_cast<uint8_t>(next_.pos[c][i] >> 8));
+            }
+            for (size_t c = 0; c < 3; c++) {
+                const uint16_t v = static_cast<uint16_t>(next_.vel[c][i]);
+                PutByte(static_cast<uint8_t>(v));
+                PutByte(static_cast<uint8_t>(v >> 8));
+                next_.dvel[c][i] = 0;
+            }
+        }
+        since_keyframe_ = 0;
+    } else {
+        const uint32_t dt_ms = now_ms - last_frame_ms_;
+        if (!BeginRecord(TAG_FRAME, now_ms, 1 + num * FRAME_BYTES_PER_BOID + 1)) return false;
+        PutByte(next_.age);
+        const int32_t interval = StateInterval(dt_ms, prev_.age, next_.age);
+
+        // Residuals as 3-bit groups with a continuation bit, packed two nibbles per byte
+        uint8_t pending = 0;
+        bool    half    = false;
+        auto put_nibble = [&](uint8_t nibble) {
+            if (half) {
+                PutByte(static_cast<uint8_t>(pending | (nibble << 4)));
+            } else {
+                pending = nibble;
+            }
+            half = !half;
+        };
+        auto put_residual = [&](int32_t r) {
+            uint32_t z = ZigZag(r);
+            while (z >= 8u) {
+                put_nibble(static_cast<uint8_t>((z & 7u) | 8u));
+                z >>= 3;
+            }
+            put_nibble(static_cast<uint8_t>(z));
+        };
+
+        for (size_t i = 0; i < num; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                const int32_t pred = PredictVelocity(prev_.vel[c][i], prev_.dvel[c][i]);
+                put_residual(static_cast<int32_t>(next_.vel[c][i]) - pred);
+                next_.dvel[c][i] = static_cast<int16_t>(
+                    ClampDelta(static_cast<int32_t>(next_.vel[c][i]) - prev_.vel[c][i]));
+            }
+            for (size_t c = 0; c < 3; c++) {
+                const int32_t pred = PredictPosition(prev_.pos[c][i], next_.vel[c][i], interval);
+                put_residual(static_cast<int32_t>(next_.pos[c][i]) - pred);
+            }
+        }
+        if (half) PutByte(pending);
+        since_keyframe_++;
+    }
+
+    prev_ = next_;
+    last_frame_ms_ = now_ms;
+    frames_++;
+    return true;
+}
+
+bool TraceReader::Init(const uint8_t* data, size_t size) {
+    data_ = data;
+    size_ = size;
+    Rewind();
+    state_.num_boids = 0;
+    if (data == nullptr || size < TRACE_HEADER_BYTES) return false;
+    for (size_t i = 0; i < 4; i++) {
+        if (data[i] != TRACE_MAGIC[i]) return false;
+    }
+    return data[4] == TRACE_VERSION;
+}
+
+bool TraceReader::GetByte(uint8_t& b) {
+    if (pos_ >= size_) return false;
+    b = data_[pos_++];
+    return true;
+}
+
+bool TraceReader::GetVarint(uint32_t& v) {
+    v = 0;
+    for (uint32_t shift = 0; shift < 35; shift += 7) {
+        uint8_t b;
+        if (!GetByte(b)) return false;
+        v |= static_cast<uint32_t>(b & 0x7Fu) << shift;
+        if (!(b & 0x80u)) return true;
+    }
+    return false;
+}
+
+bool TraceReader::Next(TraceRecord& record) {
+    uint8_t  tag;
+    uint32_t dt;
+    if (!GetByte(tag) || !GetVarint(dt)) return false;
+    time_ms_ += dt;
+    record.time_ms = time_ms_;
+
+    if (tag == TAG_EVENT) {
+        uint8_t  type, index;
+        uint32_t value;
+        if (!GetByte(type) || !GetByte(index) || !GetVarint(value)) return false;
+        if (type > static_cast<uint8_t>(TraceEventType::CHORD)) return false;
+        record.type        = TraceRecordType::EVENT;
+        record.event.type  = static_cast<TraceEventType>(type);
+        record.event.index = index;
+        record.event.value = UnZigZag(value);
+        return true;
+    }
+
+    if (tag == TAG_KEYFRAME) {
+        uint8_t num, age;
+        if (!GetByte(num) || !GetByte(age) || num > MAX_BOIDS) return false;
+        if (size_ - pos_ < num * KEYFRAME_BYTES_PER_BOID) return false;
+        for (size_t i = 0; i < num; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                state_.pos[c][i] = static_cast<uint16_t>(data_[pos_] | (data_[pos_ + 1] << 8));
+                pos_ += 2;
+            }
+            for (size_t c = 0; c < 3; c++) {
+                state_.vel[c][i] = static_cast<int16_t>(
+                    static_cast<uint16_t>(data_[pos_] | (data_[pos_ + 1] << 8)));
+                pos_ += 2;
+                state_.dvel[c][i] = 0;
+            }
+        }
+        state_.num_boids = num;
+        state_.age       = age;
+        frame_ms_        = time_ms_;
+        have_frame_      = true;
+        record.type      = TraceRecordType::KEYFRAME;
+        return true;
+    }
+
+    if (tag == TAG_FRAME) {
+        uint8_t age;
+        if (!have_frame_ || !GetByte(age)) return false;
+        const int32_t interval = StateInterval(time_ms_ - frame_ms_, state_.age, age);
+
+        uint8_t byte = 0;
+        bool    half = false;
+        bool    ok   = true;
+        auto get_nibble = [&]() -> uint8_t {
+            if (half) {
+                half = false;
+                return static_cast<uint8_t>(byte >> 4);
+            }
+            if (!GetByte(byte)) ok = false;
+            half = true;
+            return static_cast<uint8_t>(byte & 0x0Fu);
+        };
+        auto get_residual = [&]() -> int32_t {
+            uint32_t z = 0;
+            for (uint32_t shift = 0; ok && shift < 24; shift += 3) {
+                const uint8_t n = get_nibble();
+                z |= static_cast<uint32_t>(n & 7u) << shift;
+                if (!(n & 8u)) return UnZigZag(z);
+            }
+            ok = false;
+            return 0;
+        };
+
+        for (size_t i = 0; i < state_.num_boids && ok; i++) {
+            for (size_t c = 0; c < 3; c++) {
+                const int32_t vel = PredictVelocity(state_.vel[c][i], state_.dvel[c][i])
+                                  + get_residual();
+                state_.dvel[c][i] = static_cast<int16_t>(ClampDelta(vel - state_.vel[c][i]));
+                state_.vel[c][i]  = static_cast<int16_t>(vel);
+            }
+            for (size_t c = 0; c < 3; c++) {
+                state_.pos[c][i] = static_cast<uint16_t>(
+                    PredictPosition(state_.pos[c][i], state_.vel[c][i], interval) + get_residual());
+            }
+        }
+        if (!ok) {
+            have_frame_ = false;
+            return false;
+        }
+        state_.age  = age;
+        frame_ms_   = time_ms_;
+        record.type = TraceRecordType::FRAME;
+        return true;
+    }
+
+    return false;  // unknown tag
+}
+
+} // namespace murmur
@@ -0,0 +1,173 @@
+#pragma once
+#ifndef FLOCK_TRACE_H
+#define FLOCK_TRACE_H
+
+#include "boids.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace murmur {
+
+// Compact performance traces: every published flock step plus the control events that
+// shaped it, so a capture can be replayed through the voices and display exactly as it
+// was played (up to 16-bit quantization) or decoded on the host as a benchmark corpus.
+//
+// Stream layout (all multi-byte values little-endian):
+//   header    "MTRC", version byte
+//   record    tag byte, varint ms since the previous record, then by tag:
+//     KEYFRAME  boid count, state age (50 us units), per boid pos x/y/z (u16) and
+//               vel x/y/z (s16)
+//     FRAME     state age, then residuals per boid (vel x/y/z, pos x/y/z), zigzag-coded in 3-bit
+//               nibble groups (two nibbles per byte, padded to a byte at the end)
+//     EVENT     event type, index, zigzag varint value
+// Frames predict each velocity from the previous velocity and its last change, then each
+// position from the previous position moved by the new velocity (the flock's own
+// integration order), so a smooth flight costs about one nibble per component.
+// A keyframe is written every TRACE_KEYFRAME_INTERVAL frames and whenever the boid
+// count changes.
+constexpr uint8_t  TRACE_VERSION            = 1;
+constexpr size_t   TRACE_HEADER_BYTES       = 5;
+constexpr uint32_t TRACE_KEYFRAME_INTERVAL  = 256;
+constexpr float    TRACE_VEL_RANGE          = 2.0f;  // |vel| quantized up to this (units/s)
+constexpr float    TRACE_AGE_UNIT           = 0.00005f;  // state age resolution (s)
+
+// Control events recorded alongside the flock. Knob values are 0-65535; encoder turns
+// carry the increment; CHORD carries the progression mode in index and chord in value.
+enum class TraceEventType : uint8_t {
+    KNOB,
+    ENCODER_TURN,
+    ENCODER_PRESS,
+    GATE,
+    CHORD,
+};
+
+struct TraceEvent {
+    TraceEventType type;
+    uint8_t index;
+    int32_t value;
+};
+
+enum class TraceRecordType : uint8_t { KEYFRAME, FRAME, EVENT };
+
+struct TraceRecord {
+    TraceRecordType type;
+    uint32_t time_ms;   // since the first record
+    TraceEvent event;   // EVENT records only
+};
+
+static_assert(MAX_BOIDS <= 255, "trace keyframes store the boid count in one byte");
+
+// Quantized state of one recorded step
+struct TraceFrameState {
+    size_t   num_boids;
+    uint8_t  age;  // TRACE_AGE_UNIT units
+    uint16_t pos[3][MAX_BOIDS];
+    int16_t  vel[3][MAX_BOIDS];
+    int16_t  dvel[3][MAX_BOIDS];  // vel change from the frame before (prediction only)
+};
+
+// Appends records to a caller-owned buffer. Once a record no longer fits, recording
+// stops (IsFull()) and everything written so far stays a valid trace.
+class TraceWriter {
+public:
+    TraceWriter() : buffer_(nullptr), capacity_(0), size_(0), full_(true) {}
+
+    void Init(uint8_t* buffer, size_t capacity);
+
+    // One flock step. FlockT needs GetNumBoids / GetPosition / GetVelocity / GetStateAge.
+    template <typename FlockT>
+    bool WriteFrame(uint32_t now_ms, const FlockT& flock) {
+        size_t num = flock.GetNumBoids();
+        if (num > MAX_BOIDS) num = MAX_BOIDS;
+        for (size_t i = 0; i < num; i++) {
+            const Vec3 p = flock.GetPosition(i);
+            const Vec3 v = flock.GetVelocity(i);
+            next_.pos[0][i] = QuantizePosition(p.x);
+            next_.pos[1][i] = QuantizePosition(p.y);
+            next_.pos[2][i] = QuantizePosition(p.z);
+            next_.vel[0][i] = QuantizeVelocity(v.x);
+            next_.vel[1][i] = QuantizeVelocity(v.y);
+            next_.vel[2][i] = QuantizeVelocity(v.z);
+        }
+        next_.num_boids = num;
+        next_.age       = QuantizeAge(flock.GetStateAge());
+        return CommitFrame(now_ms);
+    }
+    bool WriteEvent(uint32_t now_ms, const TraceEvent& event);
+
+    const uint8_t* GetData() const { return buffer_; }
+    size_t GetSize() const { return size_; }
+    bool IsFull() const { return full_; }
+    uint32_t GetFrames() const { return frames_; }
+
+    static uint16_t QuantizePosition(float p);
+    static int16_t  QuantizeVelocity(float v);
+    static uint8_t  QuantizeAge(float seconds);
+
+private:
+    bool CommitFrame(uint32_t now_ms);
+    bool BeginRecord(uint8_t tag, uint32_t now_ms, size_t max_payload);
+    void PutByte(uint8_t b) { buffer_[size_++] = b; }
+    void PutVarint(uint32_t v);
+
+    uint8_t* buffer_;
+    size_t   capacity_;
+    size_t   size_;
+    bool     full_;
+    bool     started_;
+    uint32_t last_ms_;        // time of the last record (record times are deltas)
+    uint32_t last_frame_ms_;  // time of the last frame (prediction interval)
+    uint32_t frames_;
+    uint32_t since_keyframe_;
+    TraceFrameState prev_;  // last frame written (the decoder's prediction base)
+    TraceFrameState next_;
+};
+
+// Decodes a trace record by record. After a KEYFRAME or FRAME record the decoded state is
+// available through the flock-style accessors below.
+class TraceReader {
+public:
+    TraceReader() : data_(nullptr), size_(0), pos_(0), time_ms_(0), frame_ms_(0),
+                    have_frame_(false) {}
+
+    // False if the buffer does not start with a supported trace header
+    bool Init(const uint8_t* data, size_t size);
+    // Next record, or false at the end of the trace (or at a truncated / corrupt record)
+    bool Next(TraceRecord& record);
+    void Rewind() { pos_ = TRACE_HEADER_BYTES; time_ms_ = 0; frame_ms_ = 0; have_frame_ = false; }
+
+    bool HasFrame() const { return have_frame_; }
+    size_t GetNumBoids() const { return state_.num_boids; }
+    Vec3 GetPosition(size_t index) const {
+        return Vec3(DequantizePosition(state_.pos[0][index]),
+                    DequantizePosition(state_.pos[1][index]),
+                    DequantizePosition(state_.pos[2][index]));
+    }
+    Vec3 GetVelocity(size_t index) const {
+        return Vec3(DequantizeVelocity(state_.vel[0][index]),
+                    DequantizeVelocity(state_.vel[1][index]),
+                    DequantizeVelocity(state_.vel[2][index]));
+    }
+    float GetStateAge() const { return static_cast<float>(state_.age) * TRACE_AGE_UNIT; }
+
+    static float DequantizePosition(uint16_t q) { return static_cast<float>(q) * (1.0f / 65535.0f); }
+    static float DequantizeVelocity(int16_t q) {
+        return static_cast<float>(q) * (TRACE_VEL_RANGE / 32767.0f);
+    }
+
+private:
+    bool GetByte(uint8_t& b);
+    bool GetVarint(uint32_t& v);
+
+    const uint8_t* data_;
+    size_t   size_;
+    size_t   pos_;
+    uint32_t time_ms_;
+    uint32_t frame_ms_;
+    bool     have_frame_;
+    TraceFrameState state_;
+};
+
+} // namespace murmur
+
+#endif // FLOCK_TRACE_H
@@ -0,0 +1,182 @@
+#include "multi_flock.h"
+#include "flock_kernel.h"
+#include <cmath>
+
+namespace murmur {
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::SnapPrevious() {
+    for (size_t i = 0; i < kLanes; i++) {
+        prev_pos_x_[i] = pos_x_[i];
+        prev_pos_y_[i] = pos_y_[i];
+        prev_pos_z_[i] = pos_z_[i];
+    }
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::ParkPadding(size_t flock) {
+    FlockKernel::ParkLanes(*this, Lane(flock, num_boids_[flock]), Lane(flock + 1, 0));
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::Init(size_t num_boids) {
+    rng_state_ = 12345;  // Seed
+    if (num_boids > Capacity) num_boids = Capacity;
+
+    for (size_t f = 0; f < Flocks; f++) {
+        num_boids_[f] = num_boids;
+        for (size_t b = 0; b < num_boids; b++) {
+            FlockKernel::SpawnBoid(*this, Lane(f, b));
+        }
+        ParkPadding(f);
+    }
+    SnapPrevious();
+    accumulator_ = 0.0f;
+    alpha_       = 0.0f;
+
+    initialized_ = true;
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::SetNumBoids(size_t flock, size_t num) {
+    if (flock >= Flocks) return;
+    size_t new_num = (num > Capacity) ? Capacity : num;
+
+    for (size_t b = num_boids_[flock]; b < new_num; b++) {
+        const size_t i = Lane(flock, b);
+        FlockKernel::SpawnBoid(*this, i);
+        prev_pos_x_[i] = pos_x_[i];
+        prev_pos_y_[i] = pos_y_[i];
+        prev_pos_z_[i] = pos_z_[i];
+    }
+    num_boids_[flock] = new_num;
+    ParkPadding(flock);
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::SumFlockNeighbors(const BoidsParams (&params)[Flocks]) {
+    FlockKernel::ClearNeighborSums(*this, 0, kLanes);
+
+    // The BoidsFlock::SumAllNeighbors() kernel, run over each flock's lane block
+    for (size_t f = 0; f < Flocks; f++) {
+        const float  radius_sq = params[f].perception_radius * params[f].perception_radius;
+        const size_t lo        = Lane(f, 0);
+        const size_t hi        = lo + PaddedCapacity(num_boids_[f]);
+        stats_.pair_tests += static_cast<uint32_t>(num_boids_[f] * (hi - lo));
+        FlockKernel::SumAllPairs(*this, lo, num_boids_[f], hi, radius_sq);
+    }
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::SumCrossFlockAvoidance(float radius_sq) {
+    for (size_t i = 0; i < kLanes; i++) {
+        avoid_x_[i] = 0.0f;
+        avoid_y_[i] = 0.0f;
+        avoid_z_[i] = 0.0f;
+    }
+
+    // Each source boid of flock f pushes on the lanes before and after f's block; the
+    // two runs keep the inner loops free of a per-lane flock test.
+    for (size_t f = 0; f < Flocks; f++) {
+        const size_t own_lo = Lane(f, 0);
+        const size_t own_hi = Lane(f + 1, 0);
+        stats_.pair_tests += static_cast<uint32_t>(num_boids_[f] * (kLanes - kPadded));
+
+        for (size_t j = own_lo; j < own_lo + num_boids_[f]; j++) {
+            const float qx = pos_x_[j];
+            const float qy = pos_y_[j];
+            const float qz = pos_z_[j];
+
+            for (size_t run = 0; run < 2; run++) {
+                const size_t lo = run ? own_hi : 0;
+                const size_t hi = run ? kLanes : own_lo;
+                for (size_t i = lo; i < hi; i++) {
+                    float dx = pos_x_[i] - qx;
+                    float dy = pos_y_[i] - qy;
+                    float dz = pos_z_[i] - qz;
+                    float dist_sq = dx * dx + dy * dy + dz * dz;
+
+                    float mask    = static_cast<float>((dist_sq < radius_sq) & (dist_sq >= 0.00000001f));
+                    float inv_dsq = mask / (dist_sq + (1.0f - mask));
+
+                    avoid_x_[i] += dx * inv_dsq;
+                    avoid_y_[i] += dy * inv_dsq;
+                    avoid_z_[i] += dz * inv_dsq;
+                }
+            }
+        }
+    }
+}
+
+template <size_t Flocks, size_t Capacity>
+void MultiFlock<Flocks, Capacity>::Update(float dt, const BoidsParams (&params)[Flocks],
+                                          const CrossFlockParams& cross) {
+    if (!initialized_) return;
+
+    stats_.ticks++;
+
+    SumFlockNeighbors(params);
+    const bool avoid = cross.avoid_weight > 0.0f && Flocks > 1;
+    if (avoid) SumCrossFlockAvoidance(cross.avoid_radius * cross.avoid_radius);
+
+    // Steering + environment per flock, with that flock's params
+    for (size_t f = 0; f < Flocks; f++) {
+        const BoidsParams& p = params[f];
+        for (size_t i = Lane(f, 0); i < Lane(f, num_boids_[f]); i++) {
+            const NeighborSums sums = FlockKernel::NeighborSumsAt(*this, i);
+            const Vec3 pos(pos_x_[i], pos_y_[i], pos_z_[i]);
+            const Vec3 vel(vel_x_[i], vel_y_[i], vel_z_[i]);
+            Vec3 force = SteerFromNeighbors(sums, pos, vel, p);
+            force += BoundaryForce(pos);
+
+            // Cross-flock avoidance steers like separation, at the flock's own limits
+            if (avoid) {
+                Vec3 away(avoid_x_[i], avoid_y_[i], avoid_z_[i]);
+                if (away.MagnitudeSquared() > 0.0f) {
+                    away.SetMagnitude(p.max_speed);
+                    away = away - vel;
+                    away.Limit(p.max_force);
+                    force += away * cross.avoid_weight;
+                }
+            }
+
+            acc_x_[i] = force.x;
+            acc_y_[i] = force.y;
+            acc_z_[i] = force.z;
+        }
+    }
+
+    // Wander over every lane at once; parked lanes have a zero direction
+    FlockKernel::Wander(*this, 0, kLanes, dt);
+
+    for (size_t f = 0; f < Flocks; f++) {
+        const float max_speed = params[f].max_speed;
+        for (size_t i = Lane(f, 0); i < Lane(f, num_boids_[f]); i++) {
+            FlockKernel::IntegrateBoid(*this, i, dt, dt, max_speed);
+        }
+    }
+}
+
+template <size_t Flocks, size_t Capacity>
+size_t MultiFlock<Flocks, Capacity>::Advance(float elapsed, const BoidsParams (&params)[Flocks],
+                                             const CrossFlockParams& cross) {
+    if (!initialized_) return 0;
+    if (elapsed > 0.0f) accumulator_ += elapsed;
+
+    auto step = [&]() {
+        SnapPrevious();
+        Update(FLOCK_FIXED_DT, params, cross);
+    };
+    const size_t steps = FlockKernel::RunFixedSteps(accumulator_, FLOCK_FIXED_DT,
+                                                    FLOCK_MAX_SUBSTEPS, stats_.dropped_steps,
+                                                    step);
+
+    alpha_ = accumulator_ / FLOCK_FIXED_DT;
+    return steps;
+}
+
+// Flock counts and capacities built into this binary
+template class MultiFlock<MULTI_FLOCK_COUNT, MAX_BOIDS>;
+template class MultiFlock<4, MAX_BOIDS>;
+
+} // namespace murmur
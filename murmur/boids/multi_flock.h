@@ -0,0 +1,139 @@
+#pragma once
+#ifndef MULTI_FLOCK_H
+#define MULTI_FLOCK_H
+
+#include "boids.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace murmur {
+
+// Flocks per MultiFlock in the default build: one per output pair of the Patch
+constexpr size_t MULTI_FLOCK_COUNT = 2;
+
+// Interaction between different flocks. Boids of other flocks within avoid_radius push a
+// boid away with the same inverse-square weighting as separation; they never count as
+// neighbors for alignment or cohesion. avoid_weight = 0 disables the cross-flock pass.
+struct CrossFlockParams {
+    float avoid_weight = 0.0f;  // 0-2, like separation_weight
+    float avoid_radius = 0.1f;
+};
+
+// Flocks independent flocks ("species") of up to Capacity boids each, stepped together.
+// All flocks share one set of structure-of-arrays state: flock f owns the padded lane
+// block [f * kPadded, (f + 1) * kPadded), so one Update() sweeps every flock's hot state
+// in a single contiguous pass instead of Flocks separate objects with their own grids
+// and Verlet lists in between.
+//
+// Each flock has its own BoidsParams (weights, radius, speeds). Neighbor sums always use
+// the vectorized all-pairs kernel within a flock (neighbor_search, adaptive_step and
+// lod_stride are ignored), which is what small firmware flocks run anyway.
+// Spawning, the kernel, wander, integration and the fixed-step driver are BoidsFlock's own
+// (flock_kernel.h), so flock 0 flies exactly like a lone BoidsFlock. Member definitions
+// live in multi_flock.cpp, instantiated for MULTI_FLOCK_COUNT and 4 flocks of MAX_BOIDS.
+// Host builds only; the firmware runs a single flock.
+template <size_t Flocks, size_t Capacity>
+class MultiFlock {
+    friend struct FlockKernel;
+
+public:
+    static constexpr size_t kFlocks   = Flocks;
+    static constexpr size_t kCapacity = Capacity;
+
+    MultiFlock() : accumulator_(0.0f), alpha_(0.0f), stats_(), initialized_(false) {}
+    ~MultiFlock() {}
+
+    // Spawns num_boids boids in every flock
+    void Init(size_t num_boids);
+    // One integration step of length dt; params[f] drives flock f
+    void Update(float dt, const BoidsParams (&params)[Flocks],
+                const CrossFlockParams& cross = CrossFlockParams());
+    // Fixed-step driver, same contract as BoidsFlock::Advance() (FLOCK_FIXED_DT steps)
+    size_t Advance(float elapsed, const BoidsParams (&params)[Flocks],
+                   const CrossFlockParams& cross = CrossFlockParams());
+
+    void SetNumBoids(size_t flock, size_t num);
+    size_t GetNumBoids(size_t flock) const { return num_boids_[flock]; }
+    Vec3 GetPosition(size_t flock, size_t index) const {
+        const size_t i = Lane(flock, index);
+        return Vec3(pos_x_[i], pos_y_[i], pos_z_[i]);
+    }
+    Vec3 GetVelocity(size_t flock, size_t index) const {
+        const size_t i = Lane(flock, index);
+        return Vec3(vel_x_[i], vel_y_[i], vel_z_[i]);
+    }
+    Vec3 GetInterpolatedPosition(size_t flock, size_t index) const {
+        const size_t i = Lane(flock, index);
+        return Vec3(prev_pos_x_[i] + (pos_x_[i] - prev_pos_x_[i]) * alpha_,
+                    prev_pos_y_[i] + (pos_y_[i] - prev_pos_y_[i]) * alpha_,
+                    prev_pos_z_[i] + (pos_z_[i] - prev_pos_z_[i]) * alpha_);
+    }
+
+    // Totals over all flocks (pair_tests includes the cross-flock pass)
+    const FlockStats& GetStats() const { return stats_; }
+    void ResetStats() { stats_ = FlockStats(); }
+
+private:
+    static constexpr size_t kPadded = PaddedCapacity(Capacity);
+    static constexpr size_t kLanes  = Flocks * kPadded;
+    static_assert(Flocks > 0 && Capacity > 0, "need at least one flock of one boid");
+
+    static size_t Lane(size_t flock, size_t index) { return flock * kPadded + index; }
+
+    // Within-flock sums: the SumAllNeighbors kernel run over each flock's lane block
+    void SumFlockNeighbors(const BoidsParams (&params)[Flocks]);
+    // Cross-flock avoidance sums: every boid against the lanes of all other flocks
+    void SumCrossFlockAvoidance(float radius_sq);
+
+    void SnapPrevious();
+    void ParkPadding(size_t flock);
+
+    // Structure-of-arrays state for all flocks, flock-major
+    alignas(16) float pos_x_[kLanes];
+    alignas(16) float pos_y_[kLanes];
+    alignas(16) float pos_z_[kLanes];
+    alignas(16) float vel_x_[kLanes];
+    alignas(16) float vel_y_[kLanes];
+    alignas(16) float vel_z_[kLanes];
+    alignas(16) float acc_x_[kLanes];
+    alignas(16) float acc_y_[kLanes];
+    alignas(16) float acc_z_[kLanes];
+    alignas(16) float    wander_x_[kLanes];
+    alignas(16) float    wander_y_[kLanes];
+    alignas(16) uint32_t wander_rng_[kLanes];
+
+    // Neighbor accumulators (within flock) and avoidance accumulators (other flocks)
+    alignas(16) float sep_x_[kLanes];
+    alignas(16) float sep_y_[kLanes];
+    alignas(16) float sep_z_[kLanes];
+    alignas(16) float ali_x_[kLanes];
+    alignas(16) float ali_y_[kLanes];
+    alignas(16) float ali_z_[kLanes];
+    alignas(16) float coh_x_[kLanes];
+    alignas(16) float coh_y_[kLanes];
+    alignas(16) float coh_z_[kLanes];
+    alignas(16) float count_[kLanes];
+    alignas(16) float avoid_x_[kLanes];
+    alignas(16) float avoid_y_[kLanes];
+    alignas(16) float avoid_z_[kLanes];
+
+    float prev_pos_x_[kLanes];
+    float prev_pos_y_[kLanes];
+    float prev_pos_z_[kLanes];
+
+    float accumulator_;
+    float alpha_;
+    FlockStats stats_;
+
+    size_t num_boids_[Flocks];
+    bool initialized_;
+
+    uint32_t rng_state_;  // LCG for spawning, same sequence as BoidsFlock
+};
+
+extern template class MultiFlock<MULTI_FLOCK_COUNT, MAX_BOIDS>;
+extern template class MultiFlock<4, MAX_BOIDS>;
+
+} // namespace murmur
+
+#endif // MULTI_FLOCK_H
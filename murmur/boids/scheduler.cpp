@@ -3,7 +3,8 @@
 
 namespace murmur {
 
-void BoidScheduler::Init(float sample_rate) {
+template <size_t Capacity>
+void BoidScheduler<Capacity>::Init(float sample_rate) {
     sample_rate_ = sample_rate;
 
     // Initialize default params
@@ -15,14 +16,15 @@ void BoidScheduler::Init(float sample_rate) {
     params_.energy = 1.0f;
 
     // Initialize timers
-    for (size_t i = 0; i < MAX_BOIDS; i++) {
+    for (size_t i = 0; i < Capacity; i++) {
         trigger_timers_[i] = 0.0f;
         trigger_intervals_[i] = sample_rate_ / params_.base_density;
         triggered_[i] = false;
     }
 }
 
-GrainParams BoidScheduler::MapBoidToGrain(const Boid& boid) const {
+template <size_t Capacity>
+GrainParams BoidScheduler<Capacity>::MapBoidToGrain(const Boid& boid) const {
     GrainParams params;
 
     // X position -> buffer playback position (with offset)
@@ -61,8 +63,9 @@ GrainParams BoidScheduler::MapBoidToGrain(const Boid& boid) const {
     return params;
 }
 
-void BoidScheduler::Process(const BoidsFlock& flock, GrainPool& pool,
-                            const CircularBuffer& buffer) {
+template <size_t Capacity>
+void BoidScheduler<Capacity>::Process(const BoidsFlock<Capacity>& flock, GrainPool& pool,
+                                      const CircularBuffer& buffer) {
     size_t num_boids = flock.GetNumBoids();
 
     for (size_t i = 0; i < num_boids; i++) {
@@ -94,9 +97,11 @@ void BoidScheduler::Process(const BoidsFlock& flock, GrainPool& pool,
     }
 
     // Clear triggered flags for inactive boids
-    for (size_t i = num_boids; i < MAX_BOIDS; i++) {
+    for (size_t i = num_boids; i < Capacity; i++) {
         triggered_[i] = false;
     }
 }
 
+template class BoidScheduler<MAX_BOIDS>;
+
 } // namespace murmur
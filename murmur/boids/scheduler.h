@@ -17,6 +17,9 @@ struct SchedulerParams {
     float energy;           // Flock energy/turbulence multiplier (0-2)
 };
 
+// Per-boid grain trigger timers for a flock of up to Capacity boids.
+// Member definitions live in scheduler.cpp, instantiated for MAX_BOIDS.
+template <size_t Capacity>
 class BoidScheduler {
 public:
     BoidScheduler() : sample_rate_(48000.0f) {}
@@ -26,12 +29,12 @@ public:
     void SetParams(const SchedulerParams& params) { params_ = params; }
 
     // Process one audio sample - checks timers and triggers grains
-    void Process(const BoidsFlock& flock, GrainPool& pool,
+    void Process(const BoidsFlock<Capacity>& flock, GrainPool& pool,
                  const CircularBuffer& buffer);
 
     // Get trigger activity for visualization
     bool WasTriggered(size_t boid_idx) const {
-        if (boid_idx >= MAX_BOIDS) return false;
+        if (boid_idx >= Capacity) return false;
         return triggered_[boid_idx];
     }
 
@@ -43,13 +46,15 @@ private:
     SchedulerParams params_;
 
     // Per-boid trigger timers (in samples)
-    float trigger_timers_[MAX_BOIDS];
-    float trigger_intervals_[MAX_BOIDS];
+    float trigger_timers_[Capacity];
+    float trigger_intervals_[Capacity];
 
     // Trigger state for visualization
-    bool triggered_[MAX_BOIDS];
+    bool triggered_[Capacity];
 };
 
+extern template class BoidScheduler<MAX_BOIDS>;
+
 } // namespace murmur
 
 #endif // SCHEDULER_H
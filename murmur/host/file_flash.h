@@ -0,0 +1,93 @@
+#pragma once
+#ifndef FILE_FLASH_H
+#define FILE_FLASH_H
+
+#include "../storage/snapshot_store.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace murmur {
+
+// Host stand-in for QspiFlash: a flash image kept in RAM and mirrored to a file after
+// every operation, so a "power cycle" is just opening the file again. It keeps the chip's
+// rules (erase whole sectors to 0xFF, programming only clears bits, no page crossing)
+// and counts erases per sector. SetPowerLossAfter(n) lets the next n operations succeed
+// and fails every one after that, leaving the image as a cut in power would.
+class FileFlash {
+public:
+    FileFlash() : file_(nullptr), ops_left_(-1) {}
+    ~FileFlash() { Close(); }
+
+    // Opens (or creates, erased) an image of size bytes
+    bool Open(const char* path, uint32_t size) {
+        Close();
+        image_.assign(size, 0xFF);
+        erase_counts_.assign(size / FLASH_SECTOR_BYTES, 0);
+        ops_left_ = -1;
+        file_ = fopen(path, "r+b");
+        if (file_ != nullptr) {
+            if (fread(image_.data(), 1, size, file_) != size) {
+                // Short or foreign file: start from an erased chip
+                image_.assign(size, 0xFF);
+            }
+        } else {
+            file_ = fopen(path, "w+b");
+            if (file_ == nullptr) return false;
+        }
+        return Flush(0, size);
+    }
+
+    void Close() {
+        if (file_ != nullptr) fclose(file_);
+        file_ = nullptr;
+    }
+
+    bool Erase(uint32_t offset, uint32_t size) {
+        if (!Operation() || offset % FLASH_SECTOR_BYTES != 0 || offset + size > image_.size()) {
+            return false;
+        }
+        for (uint32_t s = offset; s < offset + size; s += FLASH_SECTOR_BYTES) {
+            for (uint32_t i = 0; i < FLASH_SECTOR_BYTES; i++) image_[s + i] = 0xFF;
+            erase_counts_[s / FLASH_SECTOR_BYTES]++;
+        }
+        return Flush(offset, size);
+    }
+
+    bool Write(uint32_t offset, const uint8_t* data, uint32_t size) {
+        if (!Operation() || offset + size > image_.size()
+            || offset / FLASH_PAGE_BYTES != (offset + size - 1) / FLASH_PAGE_BYTES) {
+            return false;
+        }
+        for (uint32_t i = 0; i < size; i++) image_[offset + i] &= data[i];
+        return Flush(offset, size);
+    }
+
+    const uint8_t* Read(uint32_t offset) const { return image_.data() + offset; }
+
+    void SetPowerLossAfter(int ops) { ops_left_ = ops; }
+    uint32_t GetEraseCount(uint32_t sector) const { return erase_counts_[sector]; }
+
+private:
+    bool Operation() {
+        if (ops_left_ == 0) return false;
+        if (ops_left_ > 0) ops_left_--;
+        return true;
+    }
+
+    bool Flush(uint32_t offset, uint32_t size) {
+        if (file_ == nullptr) return false;
+        return fseek(file_, static_cast<long>(offset), SEEK_SET) == 0
+            && fwrite(image_.data() + offset, 1, size, file_) == size
+            && fflush(file_) == 0;
+    }
+
+    FILE* file_;
+    std::vector<uint8_t>  image_;
+    std::vector<uint32_t> erase_counts_;
+    int ops_left_;  // operations until the simulated power loss, -1 = never
+};
+
+} // namespace murmur
+
+#endif // FILE_FLASH_H
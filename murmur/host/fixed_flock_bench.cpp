@@ -0,0 +1,162 @@
+// Host benchmark for the fixed-point backend: FixedFlock against BoidsFlock from the
+// same starting state and params.
+//  - cost per step, against BoidsFlock's PAIRWISE scan (the same algorithm) and its
+//    firmware setup (VERLET with adaptive steps and LOD)
+//  - drift of the flock statistics the synth listens to (spread, polarization): the
+//    two backends' trajectories part ways within seconds, so the check is whether they
+//    keep flocking alike, not whether they stay together
+//  - determinism: a hash of the fixed flock's state after the same number of steps,
+//    fed once by Update() and once by Advance() with jittered frame times; the two
+//    must match (the value can be compared against a Daisy run)
+// Exits non-zero if the determinism hashes differ.
+// Usage: ./fixed_flock_bench [seconds]
+#include "fixed_flock.h"
+#include "boids.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace murmur;
+
+namespace {
+
+// The firmware's startup params (knobs at their defaults)
+BoidsParams FlockParams(NeighborSearch search) {
+    BoidsParams p;
+    p.separation_weight = 1.0f;
+    p.alignment_weight  = 1.0f;
+    p.cohesion_weight   = 1.0f;
+    p.perception_radius = 0.25f;
+    p.max_speed         = 0.3f;
+    p.max_force         = 0.15f;
+    p.neighbor_search   = search;
+    if (search == NeighborSearch::VERLET) {
+        p.adaptive_step = true;
+        p.lod_stride    = 4;
+    }
+    return p;
+}
+
+BoidsFlock<MAX_BOIDS> float_flock;
+FixedFlock<MAX_BOIDS> fixed_flock;
+
+// Both flocks start from float_flock's seeded state
+void Seed() {
+    float_flock.Init(MAX_BOIDS);
+    fixed_flock.Init(MAX_BOIDS);
+    for (size_t i = 0; i < MAX_BOIDS; i++) {
+        fixed_flock.SetBoidState(i, float_flock.GetPosition(i), float_flock.GetVelocity(i));
+    }
+}
+
+template <class FlockT>
+double UsPerStep(FlockT& flock, const BoidsParams& params, int steps) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) flock.Update(FLOCK_FIXED_DT, params);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / steps;
+}
+
+// FNV-1a over the bit patterns of every position and velocity
+template <class FlockT>
+uint32_t StateHash(const FlockT& flock) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < flock.GetNumBoids(); i++) {
+        const Vec3 p = flock.GetPosition(i);
+        const Vec3 v = flock.GetVelocity(i);
+        const float values[6] = {p.x, p.y, p.z, v.x, v.y, v.z};
+        for (float f : values) {
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            for (int b = 0; b < 4; b++) {
+                h ^= (bits >> (8 * b)) & 0xFFu;
+                h *= 16777619u;
+            }
+        }
+    }
+    return h;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const float seconds = (argc > 1) ? static_cast<float>(atof(argv[1])) : 60.0f;
+    const int   steps   = static_cast<int>(lroundf(seconds / FLOCK_FIXED_DT));
+    const BoidsParams pairwise = FlockParams(NeighborSearch::PAIRWISE);
+    const BoidsParams firmware = FlockParams(NeighborSearch::VERLET);
+
+    // Cost per step
+    Seed();
+    const double pairwise_us = UsPerStep(float_flock, pairwise, steps);
+    Seed();
+    const double firmware_us = UsPerStep(float_flock, firmware, steps);
+    Seed();
+    const double fixed_us = UsPerStep(fixed_flock, pairwise, steps);
+    printf("%zu boids, %d steps (%.0f s)\n", MAX_BOIDS, steps, static_cast<double>(seconds));
+    printf("%-28s %10s %8s\n", "backend", "us/step", "ratio");
+    printf("%-28s %10.2f %7.2fx\n", "BoidsFlock PAIRWISE", pairwise_us, 1.0);
+    printf("%-28s %10.2f %7.2fx\n", "BoidsFlock VERLET+LOD", firmware_us,
+           firmware_us / pairwise_us);
+    printf("%-28s %10.2f %7.2fx\n\n", "FixedFlock", fixed_us, fixed_us / pairwise_us);
+
+    // Statistics drift, sampled every simulated second
+    Seed();
+    printf("%6s %14s %14s %14s %14s\n", "t (s)", "spread float", "spread fixed",
+           "polar. float", "polar. fixed");
+    const int per_second = static_cast<int>(lroundf(1.0f / FLOCK_FIXED_DT));
+    const int samples    = steps / per_second;
+    double spread_drift = 0.0, polar_drift = 0.0;
+    double spread_max   = 0.0, polar_max   = 0.0;
+    double mean_a[2]    = {0.0, 0.0};  // float: spread, polarization
+    double mean_b[2]    = {0.0, 0.0};  // fixed
+    for (int t = 1; t <= samples; t++) {
+        for (int s = 0; s < per_second; s++) {
+            float_flock.Update(FLOCK_FIXED_DT, pairwise);
+            fixed_flock.Update(FLOCK_FIXED_DT, pairwise);
+        }
+        const FlockAnalytics& a = float_flock.GetAnalytics();
+        const FlockAnalytics& b = fixed_flock.GetAnalytics();
+        const double ds = fabs(static_cast<double>(a.spread - b.spread));
+        const double dp = fabs(static_cast<double>(a.polarization - b.polarization));
+        mean_a[0] += a.spread;
+        mean_a[1] += a.polarization;
+        mean_b[0] += b.spread;
+        mean_b[1] += b.polarization;
+        spread_drift += ds;
+        polar_drift  += dp;
+        if (ds > spread_max) spread_max = ds;
+        if (dp > polar_max) polar_max = dp;
+        if (t <= 5 || t % 10 == 0) {
+            printf("%6d %14.4f %14.4f %14.4f %14.4f\n", t, static_cast<double>(a.spread),
+                   static_cast<double>(b.spread), static_cast<double>(a.polarization),
+                   static_cast<double>(b.polarization));
+        }
+    }
+    if (samples > 0) {
+        printf("%6s %14.4f %14.4f %14.4f %14.4f\n", "mean", mean_a[0] / samples,
+               mean_b[0] / samples, mean_a[1] / samples, mean_b[1] / samples);
+        printf("mean |drift|: spread %.4f, polarization %.4f\n", spread_drift / samples,
+               polar_drift / samples);
+        printf("max  |drift|: spread %.4f, polarization %.4f\n\n", spread_max, polar_max);
+    }
+
+    // Determinism: Update() x steps against Advance() with frame times alternating
+    // 0.7 / 1.3 ms (each call runs zero or one step)
+    Seed();
+    for (int s = 0; s < steps; s++) fixed_flock.Update(FLOCK_FIXED_DT, pairwise);
+    const uint32_t direct = StateHash(fixed_flock);
+
+    Seed();
+    int done = 0;
+    for (int call = 0; done < steps; call++) {
+        done += static_cast<int>(fixed_flock.Advance((call & 1) ? 0.0013f : 0.0007f, pairwise));
+    }
+    const uint32_t advanced = StateHash(fixed_flock);
+
+    const bool match = direct == advanced;
+    printf("fixed state hash after %d steps: %08x (Update), %08x (Advance)  %s\n", steps,
+           direct, advanced, match ? "match" : "MISMATCH");
+    return match ? 0 : 1;
+}
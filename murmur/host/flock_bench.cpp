@@ -0,0 +1,289 @@
+// Host benchmark for the flock engines:
+//  - BoidsFlock's structure-of-arrays neighbor kernel against the array-of-Boid layout it
+//    replaced, 16-1024 boids (forces must agree)
+//  - GRID and PAIRWISE neighbor search against BRUTE_FORCE on the same flocks, at the
+//    firmware perception radius and a small one (forces must agree)
+//  - VERLET's timed cached and rebuilt ticks (FlockStats) against PAIRWISE ticks
+//  - ParallelFlock: ms per step for 10k-100k boids on 1..N threads, and a bit-exact
+//    check of every thread count against the single-threaded run
+// Built with a 1024-boid BoidsFlock capacity (see Makefile). Exits non-zero on a mismatch.
+// CXXFLAGS="-O2 -fno-tree-vectorize" make -B flock_bench gives scalar numbers closer to
+// the Cortex-M7, which has no SIMD float math.
+// Usage: ./flock_bench [max_threads] [steps]
+#include "parallel_flock.h"
+#include "boids.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace murmur;
+
+namespace {
+
+// Firmware flocking parameters (MurmurBoids.cpp defaults)
+BoidsParams KernelParams(NeighborSearch search, float radius = 0.25f) {
+    BoidsParams params;
+    params.separation_weight = 1.0f;
+    params.alignment_weight  = 1.0f;
+    params.cohesion_weight   = 1.0f;
+    params.perception_radius = radius;
+    params.max_speed         = 0.3f;
+    params.max_force         = 0.15f;
+    params.neighbor_search   = search;
+    return params;
+}
+
+// Firmware parameters with a radius that keeps the mean neighbor count roughly constant
+// as the flock grows (ParallelFlock always searches its own grid)
+BoidsParams ParamsFor(size_t num_boids) {
+    return KernelParams(NeighborSearch::GRID,
+                        num_boids >= 100000 ? 0.03f : (num_boids >= 30000 ? 0.04f : 0.06f));
+}
+
+BoidsFlock<MAX_BOIDS> kernel_flock;
+
+// Seeded flock of num_boids, flown for a while so the neighborhoods are realistic
+void FormFlock(size_t num_boids) {
+    kernel_flock.Init(num_boids);
+    const BoidsParams params = KernelParams(NeighborSearch::BRUTE_FORCE);
+    for (int s = 0; s < 200; s++) kernel_flock.Update(FLOCK_FIXED_DT, params);
+}
+
+// Enough repetitions for ~4M pair tests per round
+int KernelReps(size_t num_boids) {
+    return static_cast<int>(std::max<size_t>(20, 4000000 / (num_boids * num_boids)));
+}
+
+// Previous layout: one Boid record per boid, each boid scanning all others with an
+// early-out branch per pair (the pre-SoA ApplyFlockingForces)
+void AosForces(const Boid* boids, size_t num_boids, const BoidsParams& params, Vec3* forces) {
+    const float radius_sq = params.perception_radius * params.perception_radius;
+    for (size_t b = 0; b < num_boids; b++) {
+        const Vec3& pos = boids[b].position;
+        NeighborSums sums;
+        sums.count = 0.0f;
+        for (size_t i = 0; i < num_boids; i++) {
+            if (i == b) continue;
+            float dist_sq = Vec3::DistanceSquared(pos, boids[i].position);
+            if (dist_sq >= radius_sq || dist_sq < 0.00000001f) continue;
+            sums.separation += (pos - boids[i].position) * (1.0f / dist_sq);
+            sums.alignment  += boids[i].velocity;
+            sums.cohesion   += boids[i].position;
+            sums.count      += 1.0f;
+        }
+        forces[b] = SteerFromNeighbors(sums, pos, boids[b].velocity, params);
+    }
+}
+
+// Largest force difference relative to the mean reference force magnitude
+double ForceError(const std::vector<Vec3>& ref, const std::vector<Vec3>& test, size_t n) {
+    double mean = 0.0, max_err = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        mean += ref[i].Magnitude();
+        max_err = std::max(max_err, static_cast<double>((test[i] - ref[i]).Magnitude()));
+    }
+    mean /= static_cast<double>(n);
+    return mean > 0.0 ? max_err / mean : max_err;
+}
+
+// us per call, best of 5 rounds of reps calls (filters scheduler noise)
+template <class Fn>
+double TimeUs(int reps, Fn fn) {
+    double best = 1e30;
+    for (int round = 0; round < 5; round++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < reps; r++) fn();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::micro>(stop - start).count() / reps);
+    }
+    return best;
+}
+
+constexpr double FORCE_TOLERANCE = 1e-3;  // float summation order only
+
+// SoA kernel (BoidsFlock, BRUTE_FORCE) vs. the AoS layout it replaced. Returns false if
+// any flock size's forces disagree.
+bool CompareLayouts() {
+    printf("neighbor kernel, all pairs (us per force pass)\n");
+    printf("%8s %10s %10s %8s %10s\n", "boids", "AoS", "SoA", "speedup", "max error");
+    bool ok = true;
+    const size_t sizes[] = {16, 64, 256, 1024};
+    for (size_t n : sizes) {
+        FormFlock(n);
+        const BoidsParams params = KernelParams(NeighborSearch::BRUTE_FORCE);
+        std::vector<Boid> boids(n);
+        for (size_t i = 0; i < n; i++) boids[i] = kernel_flock.GetBoid(i);
+        std::vector<Vec3> aos(n), soa(n);
+
+        const int reps = KernelReps(n);
+        const double aos_us = TimeUs(reps, [&]() {
+            AosForces(boids.data(), n, params, aos.data());
+        });
+        const double soa_us = TimeUs(reps, [&]() {
+            kernel_flock.ComputeFlockingForces(params, soa.data());
+        });
+        const double err = ForceError(aos, soa, n);
+        ok = ok && err <= FORCE_TOLERANCE;
+        printf("%8zu %10.2f %10.2f %7.2fx %10.1e%s\n", n, aos_us, soa_us, aos_us / soa_us, err,
+               err <= FORCE_TOLERANCE ? "" : "  MISMATCH");
+    }
+    printf("\n");
+    return ok;
+}
+
+// One exact neighbor search vs. BRUTE_FORCE (us per force pass, including any grid or
+// list build). Returns false if any flock size's forces disagree.
+bool CompareSearch(NeighborSearch search, const char* name) {
+    printf("%s vs. brute force (us per force pass)\n", name);
+    printf("%8s %7s %10s %10s %8s %10s %10s\n", "boids", "radius", "brute", name, "speedup",
+           "max error", "tests/boid");
+    bool ok = true;
+    const size_t sizes[] = {16, 64, 256, 1024};
+    const float  radii[] = {0.25f, 0.1f};
+    for (float radius : radii) {
+        for (size_t n : sizes) {
+            FormFlock(n);
+            const BoidsParams brute = KernelParams(NeighborSearch::BRUTE_FORCE, radius);
+            const BoidsParams other = KernelParams(search, radius);
+            std::vector<Vec3> ref(n), test(n);
+
+            const int reps = KernelReps(n);
+            const double brute_us = TimeUs(reps, [&]() {
+                kernel_flock.ComputeFlockingForces(brute, ref.data());
+            });
+            const double other_us = TimeUs(reps, [&]() {
+                kernel_flock.ComputeFlockingForces(other, test.data());
+            });
+            const double err = ForceError(ref, test, n);
+            ok = ok && err <= FORCE_TOLERANCE;
+
+            // Distance tests per boid in one pass (brute force always makes n)
+            const uint32_t tests_before = kernel_flock.GetStats().pair_tests;
+            kernel_flock.ComputeFlockingForces(other, test.data());
+            const double tests = static_cast<double>(kernel_flock.GetStats().pair_tests
+                                                     - tests_before) / static_cast<double>(n);
+            printf("%8zu %7.2f %10.2f %10.2f %7.2fx %10.1e %10.1f%s\n", n,
+                   static_cast<double>(radius), brute_us, other_us, brute_us / other_us, err,
+                   tests, err <= FORCE_TOLERANCE ? "" : "  MISMATCH");
+        }
+    }
+    printf("\n");
+    return ok;
+}
+
+// StatsClock for the flock's own neighbor-pass timings
+uint32_t HostUs() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// VERLET's cached ticks and the rest (rebuilds and PAIRWISE fallbacks) as FlockStats times
+// them, against PAIRWISE ticks flown from the same formed flock (10 s of 2 ms ticks)
+void VerletTiming() {
+    printf("verlet vs. pairwise (us per neighbor pass, from FlockStats)\n");
+    printf("%8s %7s %9s %9s %9s %10s %11s %10s %10s %7s\n", "boids", "radius", "rebuilds",
+           "cached", "fallback", "us/cached", "us/uncached", "verlet", "pairwise", "saved");
+    const int ticks = 5000;
+    const size_t sizes[] = {16, 64, 256};
+    const float  radii[] = {0.25f, 0.1f};
+    kernel_flock.SetStatsClock(HostUs);
+    for (float radius : radii) {
+        for (size_t n : sizes) {
+            FormFlock(n);
+            const BoidsParams pairwise = KernelParams(NeighborSearch::PAIRWISE, radius);
+            kernel_flock.ResetStats();
+            for (int t = 0; t < ticks; t++) kernel_flock.Update(FLOCK_FIXED_DT, pairwise);
+            const double pairwise_us =
+                static_cast<double>(kernel_flock.GetStats().neighbor_us) / ticks;
+
+            FormFlock(n);
+            const BoidsParams verlet = KernelParams(NeighborSearch::VERLET, radius);
+            kernel_flock.ResetStats();
+            for (int t = 0; t < ticks; t++) kernel_flock.Update(FLOCK_FIXED_DT, verlet);
+            const FlockStats& st = kernel_flock.GetStats();
+            const uint32_t uncached_ticks = ticks - st.verlet_cached_ticks;
+            const double verlet_us   = static_cast<double>(st.neighbor_us) / ticks;
+            const double cached_us   = st.verlet_cached_ticks
+                ? static_cast<double>(st.verlet_cached_us) / st.verlet_cached_ticks : 0.0;
+            const double uncached_us = uncached_ticks
+                ? static_cast<double>(st.neighbor_us - st.verlet_cached_us) / uncached_ticks
+                : 0.0;
+            printf("%8zu %7.2f %9u %9u %9u %10.2f %11.2f %10.2f %10.2f %6.0f%%\n", n,
+                   static_cast<double>(radius), st.verlet_rebuilds, st.verlet_cached_ticks,
+                   st.verlet_overflows, cached_us, uncached_us, verlet_us, pairwise_us,
+                   100.0 * (1.0 - verlet_us / pairwise_us));
+        }
+    }
+    kernel_flock.SetStatsClock(nullptr);
+    printf("\n");
+}
+
+std::vector<float> Snapshot(const ParallelFlock& flock) {
+    std::vector<float> out;
+    out.reserve(flock.GetNumBoids() * 3);
+    for (size_t i = 0; i < flock.GetNumBoids(); i++) {
+        Vec3 p = flock.GetPosition(i);
+        out.push_back(p.x);
+        out.push_back(p.y);
+        out.push_back(p.z);
+    }
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t max_threads = std::thread::hardware_concurrency();
+    if (max_threads < 4) max_threads = 4;
+    int steps = 20;
+    if (argc > 1) max_threads = static_cast<size_t>(atoi(argv[1]));
+    if (argc > 2) steps = atoi(argv[2]);
+
+    bool ok = CompareLayouts();
+    ok = CompareSearch(NeighborSearch::GRID, "grid") && ok;
+    ok = CompareSearch(NeighborSearch::PAIRWISE, "pairwise") && ok;
+    VerletTiming();
+
+    const size_t sizes[] = {10000, 30000, 100000};
+    printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    printf("%8s %7s %10s %8s %8s %s\n", "boids", "threads", "ms/step", "speedup", "stolen", "match");
+
+    for (size_t num_boids : sizes) {
+        const BoidsParams params = ParamsFor(num_boids);
+        std::vector<float> reference;
+        double base_ms = 0.0;
+
+        for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+            ParallelFlock flock(threads);
+            flock.Init(num_boids);
+            flock.Update(FLOCK_FIXED_DT, params);  // warm-up: first grid build allocates
+
+            auto start = std::chrono::steady_clock::now();
+            for (int s = 1; s < steps; s++) {
+                flock.Update(FLOCK_FIXED_DT, params);
+            }
+            auto stop = std::chrono::steady_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(stop - start).count()
+                      / (steps - 1);
+
+            std::vector<float> snap = Snapshot(flock);
+            bool match = true;
+            if (threads == 1) {
+                reference = snap;
+                base_ms   = ms;
+            } else {
+                match = memcmp(snap.data(), reference.data(), snap.size() * sizeof(float)) == 0;
+            }
+
+            printf("%8zu %7zu %10.2f %8.2f %8llu %s\n", num_boids, threads, ms, base_ms / ms,
+                   static_cast<unsigned long long>(flock.GetStolenTiles()),
+                   match ? "yes" : "NO");
+            ok = ok && match;
+        }
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+// Host benchmark for NeighborSearch::MEAN_FIELD: cost per step and flocking-force error
+// against BRUTE_FORCE on the same flock state, across the accuracy knob
+// (BoidsParams::mean_field_theta). Built with a large flock capacity (see Makefile).
+// At radius 0.25 it also checks the accuracy documented next to the default theta in
+// boids.h: at every flock size the default must stay within the error bounds below, or
+// the bench exits non-zero.
+// Usage: ./mean_field_bench [radius] [steps]
+#include "boids.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace murmur;
+
+namespace {
+
+// Force error bounds for the default theta, relative to the mean |force| (see
+// BoidsParams::mean_field_theta)
+constexpr double MEAN_ERROR_BOUND = 0.03;
+constexpr double P99_ERROR_BOUND  = 0.10;
+constexpr double MAX_ERROR_BOUND  = 0.30;
+constexpr float  CHECK_RADIUS     = 0.25f;
+
+BoidsFlock<MAX_BOIDS> flock;
+BoidsFlock<MAX_BOIDS> scratch;
+
+BoidsParams Params(float radius, NeighborSearch search, float theta) {
+    BoidsParams p;
+    p.separation_weight = 1.0f;
+    p.alignment_weight  = 1.0f;
+    p.cohesion_weight   = 1.0f;
+    p.perception_radius = radius;
+    p.max_speed         = 0.3f;
+    p.max_force         = 0.15f;
+    p.neighbor_search   = search;
+    p.mean_field_theta  = theta;
+    return p;
+}
+
+// ms per Update() from a copy of the settled flock, best of 3 rounds
+double TimeSteps(const BoidsParams& params, int steps) {
+    double best = 1e30;
+    for (int round = 0; round < 3; round++) {
+        scratch = flock;
+        auto t0 = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; s++) scratch.Update(FLOCK_FIXED_DT, params);
+        auto t1 = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(t1 - t0).count() / steps);
+    }
+    return best;
+}
+
+// Returns false if the default theta misses the documented error bounds
+bool Run(size_t num_boids, float radius, int steps) {
+    flock.Init(num_boids);
+    // Let the flock form so the neighborhoods are realistic
+    const BoidsParams grid = Params(radius, NeighborSearch::GRID, 0.0f);
+    for (int s = 0; s < 500; s++) flock.Update(FLOCK_FIXED_DT, grid);
+
+    static std::vector<Vec3> exact(MAX_BOIDS);
+    static std::vector<Vec3> approx(MAX_BOIDS);
+    scratch = flock;
+    scratch.ComputeFlockingForces(Params(radius, NeighborSearch::BRUTE_FORCE, 0.0f), exact.data());
+    double mean_force = 0.0;
+    for (size_t i = 0; i < num_boids; i++) mean_force += exact[i].Magnitude();
+    mean_force /= static_cast<double>(num_boids);
+
+    const double brute_ms = TimeSteps(Params(radius, NeighborSearch::BRUTE_FORCE, 0.0f), steps);
+    const double grid_ms  = TimeSteps(grid, steps);
+    printf("%5zu boids, radius %.2f: brute force %7.3f ms/step, grid %7.3f ms/step "
+           "(mean |force| %.3f)\n", num_boids, static_cast<double>(radius), brute_ms, grid_ms,
+           mean_force);
+
+    const float default_theta = BoidsParams().mean_field_theta;
+    const bool  check = radius == CHECK_RADIUS;
+    bool ok = true;
+    const float thetas[] = {0.0f, 0.25f, 0.4f, 0.5f, 0.75f, 1.0f};
+    for (float theta : thetas) {
+        const BoidsParams mf = Params(radius, NeighborSearch::MEAN_FIELD, theta);
+        scratch = flock;
+        scratch.ResetStats();
+        scratch.ComputeFlockingForces(mf, approx.data());
+        const FlockStats stats = scratch.GetStats();
+
+        std::vector<double> err(num_boids);
+        double sum_err = 0.0;
+        for (size_t i = 0; i < num_boids; i++) {
+            err[i] = (approx[i] - exact[i]).Magnitude() / mean_force;
+            sum_err += err[i];
+        }
+        std::sort(err.begin(), err.end());
+        const double mean_err = sum_err / num_boids;
+        const double p99_err  = err[num_boids * 99 / 100];
+        const double max_err  = err[num_boids - 1];
+
+        const double ms = TimeSteps(mf, steps);
+        const bool bounded = mean_err <= MEAN_ERROR_BOUND && p99_err <= P99_ERROR_BOUND
+                          && max_err <= MAX_ERROR_BOUND;
+        const bool checked = check && theta == default_theta;
+        ok = ok && (!checked || bounded);
+        printf("  theta %.2f: %7.3f ms/step (%4.1fx brute, %4.1fx grid), "
+               "%6.1f exact pairs + %5.1f cells per boid, force error mean %5.2f%% "
+               "p99 %5.1f%% max %5.1f%%%s\n",
+               static_cast<double>(theta), ms, brute_ms / ms, grid_ms / ms,
+               static_cast<double>(stats.pair_tests) / num_boids,
+               static_cast<double>(stats.mean_field_cells) / num_boids,
+               100.0 * mean_err, 100.0 * p99_err, 100.0 * max_err,
+               checked ? (bounded ? "  (default: ok)" : "  (default: OUT OF BOUNDS)") : "");
+    }
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const float radius = (argc > 1) ? static_cast<float>(atof(argv[1])) : 0.25f;
+    const int   steps  = (argc > 2) ? atoi(argv[2]) : 20;
+    const size_t sizes[] = {250, 1000, 2000, 4000};
+    bool ok = true;
+    for (size_t n : sizes) {
+        if (n <= MAX_BOIDS) ok = Run(n, radius, steps) && ok;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+// Host benchmark for MultiFlock: one batched Update() over K flocks against K separate
+// BoidsFlock::Update() calls with the same physics (all-pairs kernel, no LOD).
+// Also checks that flock 0 of the batch flies bit-identically to a lone BoidsFlock.
+// Usage: ./multi_flock_bench [steps]
+#include "multi_flock.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace murmur;
+
+namespace {
+
+BoidsParams SpeciesParams(size_t flock) {
+    // Distinct species: tighter, faster flocks for higher indices
+    BoidsParams p;
+    p.separation_weight = 1.5f;
+    p.alignment_weight  = 1.0f + 0.2f * static_cast<float>(flock);
+    p.cohesion_weight   = 1.0f;
+    p.perception_radius = 0.3f - 0.04f * static_cast<float>(flock);
+    p.max_speed         = 0.12f + 0.02f * static_cast<float>(flock);
+    p.max_force         = 0.4f;
+    p.neighbor_search   = NeighborSearch::BRUTE_FORCE;
+    return p;
+}
+
+template <size_t K>
+void Run(int steps) {
+    BoidsParams params[K];
+    for (size_t f = 0; f < K; f++) params[f] = SpeciesParams(f);
+
+    // K separate flocks (the first one seeded exactly like the batch's flock 0)
+    static BoidsFlock<MAX_BOIDS> separate[K];
+    for (size_t f = 0; f < K; f++) separate[f].Init(MAX_BOIDS);
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) {
+        for (size_t f = 0; f < K; f++) separate[f].Update(FLOCK_FIXED_DT, params[f]);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    static MultiFlock<K, MAX_BOIDS> batch;
+    batch.Init(MAX_BOIDS);
+    auto t2 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) batch.Update(FLOCK_FIXED_DT, params);
+    auto t3 = std::chrono::steady_clock::now();
+
+    bool match = true;
+    for (size_t b = 0; b < MAX_BOIDS; b++) {
+        Vec3 a = separate[0].GetPosition(b);
+        Vec3 c = batch.GetPosition(0, b);
+        if (a.x != c.x || a.y != c.y || a.z != c.z) match = false;
+    }
+
+    CrossFlockParams cross;
+    cross.avoid_weight = 1.0f;
+    cross.avoid_radius = 0.1f;
+    batch.Init(MAX_BOIDS);
+    auto t4 = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) batch.Update(FLOCK_FIXED_DT, params, cross);
+    auto t5 = std::chrono::steady_clock::now();
+
+    auto us_per_step = [steps](std::chrono::steady_clock::time_point a,
+                               std::chrono::steady_clock::time_point b) {
+        return std::chrono::duration<double, std::micro>(b - a).count() / steps;
+    };
+    double sep_us   = us_per_step(t0, t1);
+    double batch_us = us_per_step(t2, t3);
+    double cross_us = us_per_step(t4, t5);
+    printf("%2zu x %3zu  %10.2f %10.2f %8.2fx %10.2f   %s\n", K, MAX_BOIDS, sep_us, batch_us,
+           sep_us / batch_us, cross_us, match ? "yes" : "NO");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int steps = (argc > 1) ? atoi(argv[1]) : 20000;
+    printf("flocks     separate    batched  speedup  +avoidance  flock 0 matches\n");
+    printf("           (us/step)  (us/step)           (us/step)\n");
+    Run<MULTI_FLOCK_COUNT>(steps);
+    Run<4>(steps);
+    return 0;
+}
@@ -0,0 +1,299 @@
+#include "parallel_flock.h"
+#include <cmath>
+#include <initializer_list>
+
+namespace murmur {
+
+namespace {
+
+constexpr size_t HOST_GRID_MAX_DIM   = 64;    // cells per axis upper bound
+constexpr size_t INTEGRATE_CHUNK     = 1024;  // boids per integrate task
+
+size_t ResolveThreadCount(size_t requested) {
+    if (requested > 0) return requested;
+    size_t hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+} // namespace
+
+ParallelFlock::ParallelFlock(size_t num_threads)
+    : num_threads_(ResolveThreadCount(num_threads)), num_boids_(0), grid_dim_(1),
+      step_dt_(0.0f), radius_sq_(0.0f), turn_scale_(0.0f), params_(),
+      queues_(num_threads_), generation_(0), pending_(0), quit_(false),
+      phase_(Phase::FORCE), stolen_tiles_(0), rng_state_(12345) {
+    // Worker 0 is the thread that calls Update()
+    for (size_t w = 1; w < num_threads_; w++) {
+        threads_.emplace_back(&ParallelFlock::WorkerLoop, this, w);
+    }
+}
+
+ParallelFlock::~ParallelFlock() {
+    {
+        std::lock_guard<std::mutex> guard(pool_lock_);
+        quit_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& t : threads_) {
+        t.join();
+    }
+}
+
+float ParallelFlock::Random01() {
+    // Linear congruential generator
+    rng_state_ = rng_state_ * 1103515245 + 12345;
+    return static_cast<float>((rng_state_ >> 16) & 0x7FFF) / 32767.0f;
+}
+
+void ParallelFlock::Init(size_t num_boids) {
+    rng_state_ = 12345;  // Seed
+    num_boids_ = num_boids;
+
+    for (std::vector<float>* v : {&pos_x_, &pos_y_, &pos_z_, &vel_x_, &vel_y_, &vel_z_,
+                                  &acc_x_, &acc_y_, &acc_z_, &wander_x_, &wander_y_,
+                                  &sorted_pos_x_, &sorted_pos_y_, &sorted_pos_z_,
+                                  &sorted_vel_x_, &sorted_vel_y_, &sorted_vel_z_}) {
+        v->assign(num_boids, 0.0f);
+    }
+    wander_rng_.assign(num_boids, 1u);
+    cell_of_.assign(num_boids, 0);
+    sorted_idx_.assign(num_boids, 0);
+
+    // Same spawn distribution and stream seeding as BoidsFlock::InitBoid()
+    for (size_t i = 0; i < num_boids; i++) {
+        pos_x_[i] = BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        pos_y_[i] = BOUNDARY_MARGIN_XY + Random01() * (1.0f - 2.0f * BOUNDARY_MARGIN_XY);
+        pos_z_[i] = 0.3f + Random01() * 0.4f;
+        vel_x_[i] = (Random01() - 0.5f) * 0.02f;
+        vel_y_[i] = (Random01() - 0.5f) * 0.02f;
+        vel_z_[i] = (Random01() - 0.5f) * 0.01f;
+
+        float angle = Random01() * 6.2832f;
+        wander_x_[i] = cosf(angle);
+        wander_y_[i] = sinf(angle);
+        uint32_t seed = rng_state_ ^ (static_cast<uint32_t>(i + 1) * 0x9E3779B9u);
+        wander_rng_[i] = seed ? seed : 1u;
+    }
+    stolen_tiles_ = 0;
+}
+
+size_t ParallelFlock::CellCoord(float v) const {
+    int c = static_cast<int>(v * static_cast<float>(grid_dim_));
+    if (c < 0) c = 0;
+    if (c >= static_cast<int>(grid_dim_)) c = static_cast<int>(grid_dim_) - 1;
+    return static_cast<size_t>(c);
+}
+
+void ParallelFlock::BuildGrid(float radius) {
+    // Widest cell count that still keeps every cell >= radius
+    size_t dim = (radius > 0.0f) ? static_cast<size_t>(1.0f / radius) : 1;
+    if (dim < 1) dim = 1;
+    if (dim > HOST_GRID_MAX_DIM) dim = HOST_GRID_MAX_DIM;
+    grid_dim_ = dim;
+    const size_t num_cells = dim * dim * dim;
+
+    // Counting sort; serial, so slot order (and therefore summation order) is fixed
+    cell_start_.assign(num_cells + 1, 0);
+    for (size_t i = 0; i < num_boids_; i++) {
+        size_t cell = (CellCoord(pos_z_[i]) * dim + CellCoord(pos_y_[i])) * dim
+                    + CellCoord(pos_x_[i]);
+        cell_of_[i] = static_cast<uint32_t>(cell);
+        cell_start_[cell + 1]++;
+    }
+    for (size_t c = 0; c < num_cells; c++) {
+        cell_start_[c + 1] += cell_start_[c];
+    }
+
+    std::vector<uint32_t> fill(cell_start_.begin(), cell_start_.end() - 1);
+    for (size_t i = 0; i < num_boids_; i++) {
+        size_t slot = fill[cell_of_[i]]++;
+        sorted_idx_[slot]   = static_cast<uint32_t>(i);
+        sorted_pos_x_[slot] = pos_x_[i];
+        sorted_pos_y_[slot] = pos_y_[i];
+        sorted_pos_z_[slot] = pos_z_[i];
+        sorted_vel_x_[slot] = vel_x_[i];
+        sorted_vel_y_[slot] = vel_y_[i];
+        sorted_vel_z_[slot] = vel_z_[i];
+    }
+}
+
+void ParallelFlock::ComputeTileForces(size_t tile) {
+    // A tile is one x-row of cells: tile = z * dim + y. Its boids are one sorted run.
+    const size_t dim = grid_dim_;
+    const size_t cy  = tile % dim;
+    const size_t cz  = tile / dim;
+    const size_t y_lo = (cy > 0) ? cy - 1 : 0;
+    const size_t y_hi = (cy + 1 < dim) ? cy + 1 : dim - 1;
+    const size_t z_lo = (cz > 0) ? cz - 1 : 0;
+    const size_t z_hi = (cz + 1 < dim) ? cz + 1 : dim - 1;
+
+    for (size_t cx = 0; cx < dim; cx++) {
+        const size_t cell = tile * dim + cx;
+        const size_t x_lo = (cx > 0) ? cx - 1 : 0;
+        const size_t x_hi = (cx + 1 < dim) ? cx + 1 : dim - 1;
+
+        for (size_t slot = cell_start_[cell]; slot < cell_start_[cell + 1]; slot++) {
+            const size_t i  = sorted_idx_[slot];
+            const float  px = sorted_pos_x_[slot];
+            const float  py = sorted_pos_y_[slot];
+            const float  pz = sorted_pos_z_[slot];
+
+            NeighborSums sums;
+            sums.count = 0.0f;
+            for (size_t z = z_lo; z <= z_hi; z++) {
+                for (size_t y = y_lo; y <= y_hi; y++) {
+                    size_t row   = (z * dim + y) * dim;
+                    size_t begin = cell_start_[row + x_lo];
+                    size_t end   = cell_start_[row + x_hi + 1];
+
+                    for (size_t j = begin; j < end; j++) {
+                        float dx = px - sorted_pos_x_[j];
+                        float dy = py - sorted_pos_y_[j];
+                        float dz = pz - sorted_pos_z_[j];
+                        float dist_sq = dx * dx + dy * dy + dz * dz;
+                        if (dist_sq >= radius_sq_ || dist_sq < 0.00000001f) continue;
+
+                        float inv_dsq = 1.0f / dist_sq;
+                        sums.separation += Vec3(dx * inv_dsq, dy * inv_dsq, dz * inv_dsq);
+                        sums.alignment  += Vec3(sorted_vel_x_[j], sorted_vel_y_[j],
+                                                sorted_vel_z_[j]);
+                        sums.cohesion   += Vec3(sorted_pos_x_[j], sorted_pos_y_[j],
+                                                sorted_pos_z_[j]);
+                        sums.count += 1.0f;
+                    }
+                }
+            }
+
+            const Vec3 pos(px, py, pz);
+            Vec3 force = SteerFromNeighbors(sums, pos, GetVelocity(i), params_);
+            force += BoundaryForce(pos);
+
+            RotateWander(wander_rng_[i], wander_x_[i], wander_y_[i], turn_scale_);
+            force.x += wander_x_[i] * WANDER_STRENGTH;
+            force.y += wander_y_[i] * WANDER_STRENGTH;
+
+            acc_x_[i] = force.x;
+            acc_y_[i] = force.y;
+            acc_z_[i] = force.z;
+        }
+    }
+}
+
+void ParallelFlock::IntegrateChunk(size_t chunk) {
+    const float dt = step_dt_;
+    size_t end = (chunk + 1) * INTEGRATE_CHUNK;
+    if (end > num_boids_) end = num_boids_;
+
+    for (size_t i = chunk * INTEGRATE_CHUNK; i < end; i++) {
+        Vec3 vel(vel_x_[i] + acc_x_[i] * dt,
+                 vel_y_[i] + acc_y_[i] * dt,
+                 vel_z_[i] + acc_z_[i] * dt);
+        vel.Limit(params_.max_speed);
+
+        Vec3 pos(pos_x_[i] + vel.x * dt,
+                 pos_y_[i] + vel.y * dt,
+                 pos_z_[i] + vel.z * dt);
+        if (!std::isfinite(pos.x) || !std::isfinite(pos.y) || !std::isfinite(pos.z)) {
+            pos = Vec3(0.5f, 0.5f, 0.5f);
+        }
+        pos.x = pos.x < 0.0f ? 0.0f : (pos.x > 1.0f ? 1.0f : pos.x);
+        pos.y = pos.y < 0.0f ? 0.0f : (pos.y > 1.0f ? 1.0f : pos.y);
+        pos.z = pos.z < 0.0f ? 0.0f : (pos.z > 1.0f ? 1.0f : pos.z);
+
+        vel_x_[i] = vel.x;
+        vel_y_[i] = vel.y;
+        vel_z_[i] = vel.z;
+        pos_x_[i] = pos.x;
+        pos_y_[i] = pos.y;
+        pos_z_[i] = pos.z;
+    }
+}
+
+void ParallelFlock::Update(float dt, const BoidsParams& params) {
+    if (num_boids_ == 0) return;
+
+    step_dt_    = dt;
+    radius_sq_  = params.perception_radius * params.perception_radius;
+    turn_scale_ = WanderTurnScale(dt);
+    params_     = params;
+
+    BuildGrid(params.perception_radius);
+    RunPhase(Phase::FORCE, grid_dim_ * grid_dim_);
+    RunPhase(Phase::INTEGRATE, (num_boids_ + INTEGRATE_CHUNK - 1) / INTEGRATE_CHUNK);
+}
+
+void ParallelFlock::RunPhase(Phase phase, size_t num_tasks) {
+    // Contiguous blocks per worker keep neighboring tiles (and their cells) on one core
+    // until someone runs dry and starts stealing
+    for (size_t w = 0; w < num_threads_; w++) {
+        std::lock_guard<std::mutex> guard(queues_[w].lock);
+        queues_[w].begin = num_tasks * w / num_threads_;
+        queues_[w].end   = num_tasks * (w + 1) / num_threads_;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(pool_lock_);
+        phase_   = phase;
+        pending_ = num_threads_ - 1;
+        generation_++;
+    }
+    start_cv_.notify_all();
+
+    DrainTasks(0);
+
+    std::unique_lock<std::mutex> wait(pool_lock_);
+    done_cv_.wait(wait, [this] { return pending_ == 0; });
+}
+
+void ParallelFlock::WorkerLoop(size_t worker) {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> wait(pool_lock_);
+            start_cv_.wait(wait, [this, seen] { return quit_ || generation_ != seen; });
+            if (quit_) return;
+            seen = generation_;
+        }
+
+        DrainTasks(worker);
+
+        std::lock_guard<std::mutex> guard(pool_lock_);
+        if (--pending_ == 0) done_cv_.notify_one();
+    }
+}
+
+void ParallelFlock::DrainTasks(size_t worker) {
+    size_t task;
+    while (NextTask(worker, task)) {
+        if (phase_ == Phase::FORCE) {
+            ComputeTileForces(task);
+        } else {
+            IntegrateChunk(task);
+        }
+    }
+}
+
+bool ParallelFlock::NextTask(size_t worker, size_t& task) {
+    {
+        TaskQueue& own = queues_[worker];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (own.begin < own.end) {
+            task = own.begin++;
+            return true;
+        }
+    }
+
+    // Own queue empty: steal from the back of the next non-empty queue
+    for (size_t k = 1; k < num_threads_; k++) {
+        TaskQueue& victim = queues_[(worker + k) % num_threads_];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.begin < victim.end) {
+            task = --victim.end;
+            stolen_tiles_++;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace murmur
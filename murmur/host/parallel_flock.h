@@ -0,0 +1,119 @@
+#pragma once
+#ifndef PARALLEL_FLOCK_H
+#define PARALLEL_FLOCK_H
+
+#include "../boids/boids.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace murmur {
+
+// Host-only flock engine for offline rendering and visualization with 10k-100k boids.
+// Not part of the firmware build (needs threads and heap storage).
+//
+// Same physics as BoidsFlock in GRID mode (SteerFromNeighbors, BoundaryForce and the
+// per-boid wander streams), split into two parallel phases per step:
+//   force     - worker threads pull spatial tiles (one x-row of grid cells each) from
+//               their own queue and steal from the back of others' queues when empty;
+//   integrate - velocity / position update over fixed index chunks.
+// Every boid's force is computed by exactly one task, from read-only state and in a fixed
+// neighbor order, so results are bit-identical for any thread count.
+class ParallelFlock {
+public:
+    // num_threads = 0 uses std::thread::hardware_concurrency(). The calling thread
+    // counts as one worker.
+    explicit ParallelFlock(size_t num_threads = 0);
+    ~ParallelFlock();
+
+    ParallelFlock(const ParallelFlock&) = delete;
+    ParallelFlock& operator=(const ParallelFlock&) = delete;
+
+    void Init(size_t num_boids);
+    // One step of length dt. params.neighbor_search, adaptive_step and lod_stride are
+    // ignored: the engine always uses its own cell grid and updates every boid.
+    void Update(float dt, const BoidsParams& params);
+
+    size_t GetNumBoids() const { return num_boids_; }
+    size_t GetNumThreads() const { return num_threads_; }
+    Vec3 GetPosition(size_t index) const {
+        return Vec3(pos_x_[index], pos_y_[index], pos_z_[index]);
+    }
+    Vec3 GetVelocity(size_t index) const {
+        return Vec3(vel_x_[index], vel_y_[index], vel_z_[index]);
+    }
+
+    // Tiles taken from another worker's queue since Init() (load-balance instrumentation)
+    uint64_t GetStolenTiles() const { return stolen_tiles_.load(); }
+
+private:
+    enum class Phase : uint8_t { FORCE, INTEGRATE };
+
+    // Per-worker task range [begin, end): the owner pops from the front, thieves take
+    // from the back. Padded to a cache line so workers do not share lines.
+    struct alignas(64) TaskQueue {
+        std::mutex lock;
+        size_t begin;
+        size_t end;
+    };
+
+    void BuildGrid(float radius);
+    size_t CellCoord(float v) const;
+    void ComputeTileForces(size_t tile);
+    void IntegrateChunk(size_t chunk);
+
+    // Runs num_tasks tasks of the given phase on all workers and returns when all are done
+    void RunPhase(Phase phase, size_t num_tasks);
+    void WorkerLoop(size_t worker);
+    void DrainTasks(size_t worker);
+    bool NextTask(size_t worker, size_t& task);
+
+    size_t num_threads_;
+    size_t num_boids_;
+
+    // Structure-of-arrays state, indexed by boid
+    std::vector<float> pos_x_, pos_y_, pos_z_;
+    std::vector<float> vel_x_, vel_y_, vel_z_;
+    std::vector<float> acc_x_, acc_y_, acc_z_;
+    std::vector<float> wander_x_, wander_y_;
+    std::vector<uint32_t> wander_rng_;
+
+    // Cell grid (counting sort, x-fastest like BoidsFlock's): cell c holds sorted slots
+    // [cell_start_[c], cell_start_[c + 1]); sorted_* are copies in slot order.
+    size_t grid_dim_;
+    std::vector<uint32_t> cell_start_;
+    std::vector<uint32_t> cell_of_;
+    std::vector<uint32_t> sorted_idx_;
+    std::vector<float> sorted_pos_x_, sorted_pos_y_, sorted_pos_z_;
+    std::vector<float> sorted_vel_x_, sorted_vel_y_, sorted_vel_z_;
+
+    // Current step's inputs, read by the workers
+    float step_dt_;
+    float radius_sq_;
+    float turn_scale_;
+    BoidsParams params_;
+
+    // Worker pool. generation_ advances once per phase; pending_ counts helper threads
+    // still working on it.
+    std::vector<std::thread> threads_;
+    std::vector<TaskQueue> queues_;
+    std::mutex pool_lock_;
+    std::condition_variable start_cv_;
+    std::condition_variable done_cv_;
+    uint64_t generation_;
+    size_t pending_;
+    bool quit_;
+    Phase phase_;
+    std::atomic<uint64_t> stolen_tiles_;
+
+    uint32_t rng_state_;  // LCG for spawning, same sequence as BoidsFlock
+    float Random01();
+};
+
+} // namespace murmur
+
+#endif // PARALLEL_FLOCK_H
@@ -0,0 +1,80 @@
+#pragma once
+#ifndef HOST_DAISYSP_SHIM_H
+#define HOST_DAISYSP_SHIM_H
+
+// Host stand-in for the parts of DaisySP the audio headers use, so they can be built and
+// benchmarked off-target. Svf follows DaisySP's svf.cpp (double-sampled Chamberlin state
+// variable filter) closely enough for timing and for comparing two render paths.
+#include <algorithm>
+#include <cmath>
+
+namespace daisysp {
+
+class Svf {
+public:
+    void Init(float sample_rate) {
+        sr_        = sample_rate;
+        fc_        = 200.0f;
+        res_       = 0.5f;
+        drive_     = 0.5f;
+        pre_drive_ = 0.5f;
+        freq_      = 0.25f;
+        damp_      = 0.0f;
+        notch_ = low_ = high_ = band_ = peak_ = 0.0f;
+        out_low_ = out_high_ = out_band_ = out_peak_ = out_notch_ = 0.0f;
+        fc_max_ = sr_ / 3.0f;
+    }
+
+    void Process(float in) {
+        out_low_ = out_high_ = out_band_ = out_peak_ = out_notch_ = 0.0f;
+        for (int pass = 0; pass < 2; pass++) {
+            notch_ = in - damp_ * band_;
+            low_   = low_ + freq_ * band_;
+            high_  = notch_ - low_;
+            band_  = freq_ * high_ + band_ - drive_ * band_ * band_ * band_;
+            peak_  = low_ - high_;
+            out_low_   += 0.5f * low_;
+            out_high_  += 0.5f * high_;
+            out_band_  += 0.5f * band_;
+            out_peak_  += 0.5f * peak_;
+            out_notch_ += 0.5f * notch_;
+        }
+    }
+
+    void SetFreq(float f) {
+        fc_   = std::min(std::max(f, 1.0e-6f), fc_max_);
+        freq_ = 2.0f * sinf(3.14159265f * std::min(0.25f, fc_ / (sr_ * 2.0f)));
+        UpdateDamp();
+    }
+
+    void SetRes(float r) {
+        res_ = std::min(std::max(r, 0.0f), 1.0f);
+        UpdateDamp();
+        drive_ = pre_drive_ * res_;
+    }
+
+    void SetDrive(float d) {
+        pre_drive_ = std::min(std::max(d * 0.1f, 0.0f), 1.0f);
+        drive_     = pre_drive_ * res_;
+    }
+
+    float Low() const { return out_low_; }
+    float High() const { return out_high_; }
+    float Band() const { return out_band_; }
+    float Notch() const { return out_notch_; }
+    float Peak() const { return out_peak_; }
+
+private:
+    void UpdateDamp() {
+        damp_ = std::min(2.0f * (1.0f - powf(res_, 0.25f)),
+                         std::min(2.0f, 2.0f / freq_ - freq_ * 0.5f));
+    }
+
+    float sr_, fc_, res_, drive_, pre_drive_, freq_, damp_, fc_max_;
+    float notch_, low_, high_, band_, peak_;
+    float out_low_, out_high_, out_band_, out_peak_, out_notch_;
+};
+
+} // namespace daisysp
+
+#endif // HOST_DAISYSP_SHIM_H
@@ -0,0 +1,219 @@
+// Host checks for the warm-start snapshot (see storage/snapshot_store.h), against a
+// file-backed flash image in place of the QSPI chip.
+//   ./snapshot_check [image]   (default snapshot_check.img, removed afterwards)
+// 1. round trip: save a rig mid-flight, "power cycle" (reopen the image), restore
+// 2. power loss: cut the power after every possible flash operation of a save
+// 3. wear: erase counts across the sector ring after many saves
+// 4. warm vs. cold start: how long the flock takes to re-form
+#include "file_flash.h"
+#include "../storage/rig_snapshot.h"
+#include "flock_analytics.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace murmur;
+
+namespace {
+
+constexpr uint32_t IMAGE_BYTES  = 64 * 1024;
+constexpr uint32_t RING_SECTORS = 16;
+
+BoidsFlock<MAX_BOIDS> flock;
+BoidsFlock<MAX_BOIDS> restored;
+BoidsParams params;
+
+void Drain(SnapshotStore<FileFlash>& store) {
+    while (store.IsBusy()) store.Poll();
+}
+
+// Polarization of the flock after t seconds of 2 ms steps
+float RunFor(BoidsFlock<MAX_BOIDS>& f, float seconds) {
+    const int steps = static_cast<int>(seconds / 0.002f + 0.5f);
+    for (int i = 0; i < steps; i++) f.Advance(0.002f, params);
+    FlockAnalytics a;
+    ComputeFlockAnalytics(f, a);
+    return a.polarization;
+}
+
+// Seconds until the polarization first reaches target (checked every 100 ms)
+float TimeToFormed(BoidsFlock<MAX_BOIDS>& f, float target, float limit) {
+    for (float t = 0.0f; t < limit; t += 0.1f) {
+        FlockAnalytics a;
+        ComputeFlockAnalytics(f, a);
+        if (a.polarization >= target) return t;
+        RunFor(f, 0.1f);
+    }
+    return limit;
+}
+
+int RoundTrip(const char* path, RigSnapshot& snap) {
+    FileFlash flash;
+    flash.Open(path, IMAGE_BYTES);
+    SnapshotStore<FileFlash> store;
+    store.Init(&flash, 0, RING_SECTORS);
+
+    ScaleQuantizer sq;
+    ChordProgression chord;
+    AxisMapping axes;
+    sq.SetRoot(2);
+    sq.SetScale(ScaleType::DORIAN);
+    sq.SetBaseOctave(4);
+    chord.Increment(1, 0, sq);
+    axes.x = Param::FREQ;
+    axes.y = Param::PAN;
+
+    flock.Init(MAX_BOIDS < 12 ? MAX_BOIDS : 12);
+    RunFor(flock, 20.0f);
+    snap.settings = CaptureSettings(sq, chord, axes, static_cast<int>(flock.GetNumBoids()));
+    CaptureFlock(flock, snap);
+    if (!store.Save(RIG_SNAPSHOT_VERSION, &snap, sizeof(snap))) return 1;
+    int ops = 0;
+    while (store.IsBusy()) {
+        store.Poll();
+        ops++;
+    }
+    flash.Close();
+
+    // Power cycle
+    FileFlash flash2;
+    flash2.Open(path, IMAGE_BYTES);
+    SnapshotStore<FileFlash> store2;
+    store2.Init(&flash2, 0, RING_SECTORS);
+    RigSnapshot loaded;
+    if (!store2.Load(RIG_SNAPSHOT_VERSION, &loaded, sizeof(loaded))) {
+        printf("round trip: FAILED to load\n");
+        return 1;
+    }
+    ScaleQuantizer sq2;
+    ChordProgression chord2;
+    AxisMapping axes2;
+    ApplySettings(loaded.settings, 0, sq2, chord2, axes2);
+    restored.Init(loaded.settings.num_boids);
+    RestoreFlock(restored, loaded);
+
+    float pos_err = 0.0f, vel_err = 0.0f;
+    for (size_t i = 0; i < flock.GetNumBoids(); i++) {
+        Vec3 dp = restored.GetPosition(i) - flock.GetPosition(i);
+        Vec3 dv = restored.GetVelocity(i) - flock.GetVelocity(i);
+        pos_err = fmaxf(pos_err, fmaxf(fabsf(dp.x), fmaxf(fabsf(dp.y), fabsf(dp.z))));
+        vel_err = fmaxf(vel_err, fmaxf(fabsf(dv.x), fmaxf(fabsf(dv.y), fabsf(dv.z))));
+    }
+    const bool settings_ok = sq2.GetRoot() == 2 && sq2.GetScale() == ScaleType::DORIAN
+                          && sq2.GetBaseOctave() == 4 && chord2.GetMode() == chord.GetMode()
+                          && axes2.x == Param::FREQ && axes2.y == Param::PAN
+                          && axes2.z == Param::AMP;
+    const bool ok = settings_ok && restored.GetNumBoids() == flock.GetNumBoids()
+                 && pos_err < 1e-4f && vel_err < 1e-3f;
+    printf("round trip: %zu bytes in %d flash ops, %zu boids, max error pos %.1e vel %.1e, "
+           "settings %s%s\n", sizeof(snap), ops, restored.GetNumBoids(),
+           static_cast<double>(pos_err), static_cast<double>(vel_err),
+           settings_ok ? "ok" : "WRONG", ok ? "" : "  FAILED");
+    return ok ? 0 : 1;
+}
+
+int PowerLoss(const char* path, const RigSnapshot& old_snap) {
+    RigSnapshot new_snap = old_snap;
+    new_snap.settings.root = 7;
+    for (size_t i = 0; i < MAX_BOIDS; i++) new_snap.pos[i][0] ^= 0x5555;
+
+    int failures = 0, cut = 0;
+    for (;; cut++) {
+        // The image holds old_snap (from the round trip, plus one save per earlier cut)
+        FileFlash flash;
+        flash.Open(path, IMAGE_BYTES);
+        SnapshotStore<FileFlash> store;
+        store.Init(&flash, 0, RING_SECTORS);
+        const uint32_t seq = store.GetSequence();
+        store.Save(RIG_SNAPSHOT_VERSION, &new_snap, sizeof(new_snap));
+        flash.SetPowerLossAfter(cut);
+        Drain(store);
+        const bool completed = store.GetSequence() == seq + 1;
+        flash.Close();
+
+        FileFlash flash2;
+        flash2.Open(path, IMAGE_BYTES);
+        SnapshotStore<FileFlash> store2;
+        store2.Init(&flash2, 0, RING_SECTORS);
+        RigSnapshot loaded;
+        const bool got = store2.Load(RIG_SNAPSHOT_VERSION, &loaded, sizeof(loaded));
+        const RigSnapshot& expect = completed ? new_snap : old_snap;
+        if (!got || memcmp(&loaded, &expect, sizeof(loaded)) != 0) failures++;
+
+        if (completed) {
+            // Put old_snap back on top for the next cut
+            store2.Save(RIG_SNAPSHOT_VERSION, &old_snap, sizeof(old_snap));
+            Drain(store2);
+            break;
+        }
+        // Interrupted saves leave a dead sector; rewrite old_snap as the newest
+        store2.Save(RIG_SNAPSHOT_VERSION, &old_snap, sizeof(old_snap));
+        Drain(store2);
+    }
+    printf("power loss: cut after each of %d flash ops, %d bad loads%s\n", cut + 1, failures,
+           failures ? "  FAILED" : "");
+    return failures ? 1 : 0;
+}
+
+int Wear(const char* path, const RigSnapshot& snap) {
+    FileFlash flash;
+    flash.Open(path, IMAGE_BYTES);
+    SnapshotStore<FileFlash> store;
+    store.Init(&flash, 0, RING_SECTORS);
+    const int saves = 1600;
+    for (int i = 0; i < saves; i++) {
+        store.Save(RIG_SNAPSHOT_VERSION, &snap, sizeof(snap));
+        Drain(store);
+    }
+    uint32_t lo = ~0u, hi = 0;
+    for (uint32_t s = 0; s < RING_SECTORS; s++) {
+        lo = flash.GetEraseCount(s) < lo ? flash.GetEraseCount(s) : lo;
+        hi = flash.GetEraseCount(s) > hi ? flash.GetEraseCount(s) : hi;
+    }
+    printf("wear: %d saves over %u sectors, erases per sector %u-%u\n", saves, RING_SECTORS, lo, hi);
+    return hi - lo <= 1 ? 0 : 1;
+}
+
+void WarmVsCold(const RigSnapshot& snap) {
+    const float target = 0.9f;
+    const float limit  = 60.0f;
+    float cold = 0.0f, warm = 0.0f;
+    const int runs = 10;
+    for (int r = 0; r < runs; r++) {
+        // Different seeds: Init() reseeds, so run on from a scattered state
+        flock.Init(snap.settings.num_boids);
+        for (int s = 0; s <= r; s++) flock.Scatter();
+        cold += TimeToFormed(flock, target, limit);
+
+        restored.Init(snap.settings.num_boids);
+        RestoreFlock(restored, snap);
+        warm += TimeToFormed(restored, target, limit);
+    }
+    printf("time to a formed flock (polarization >= %.1f), mean of %d: cold %.1f s, warm %.1f s\n",
+           static_cast<double>(target), runs, static_cast<double>(cold / runs),
+           static_cast<double>(warm / runs));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "snapshot_check.img";
+    remove(path);
+
+    params.separation_weight = 1.0f;
+    params.alignment_weight  = 1.0f;
+    params.cohesion_weight   = 1.0f;
+    params.perception_radius = 0.25f;
+    params.max_speed         = 0.3f;
+    params.max_force         = 0.15f;
+    params.neighbor_search   = NeighborSearch::VERLET;
+
+    RigSnapshot snap;
+    int result = RoundTrip(path, snap);
+    result |= PowerLoss(path, snap);
+    result |= Wear(path, snap);
+    WarmVsCold(snap);
+
+    if (argc <= 1) remove(path);
+    return result;
+}
@@ -0,0 +1,180 @@
+// Host benchmark for SvfBank against one daisysp::Svf per voice (host stand-in, see
+// shim/), the way OscVoice used it: every voice's cutoff changes once per block, then the
+// filters run sample by sample. Prints us per 48-sample block for the cutoff updates alone
+// and for updates plus filtering, the bank's largest coefficient error over the cutoff
+// range, and the largest output difference between the two paths.
+// Usage: ./svf_bench [voices] [blocks]
+#include "daisysp.h"
+#include "../audio/svf_bank.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace murmur;
+
+namespace {
+
+constexpr size_t kMaxVoices  = 64;
+constexpr size_t kBlockSize  = 48;
+constexpr size_t kLanes      = 4;
+constexpr float  kSampleRate = 48000.0f;
+constexpr size_t kInputBlocks = 256;  // input recycled after this many blocks
+
+daisysp::Svf       svfs[kMaxVoices];
+SvfBank<kMaxVoices> bank;
+float input[kInputBlocks][kMaxVoices][kBlockSize];
+float cutoffs[kInputBlocks][kMaxVoices];
+
+float Cutoff(size_t v, size_t b) { return cutoffs[b % kInputBlocks][v]; }
+
+void Init() {
+    for (size_t v = 0; v < kMaxVoices; v++) {
+        svfs[v].Init(kSampleRate);
+        svfs[v].SetRes(0.1f);
+        svfs[v].SetDrive(0.0f);
+    }
+    bank.Init(kSampleRate, 0.1f);
+}
+
+// Per-voice Svf: SetFreq per voice, then sample-outer / voice-inner as OscVoice did
+void RenderSvf(size_t num_voices, size_t b, float* out) {
+    for (size_t v = 0; v < num_voices; v++) svfs[v].SetFreq(Cutoff(v, b));
+    const float (*in)[kBlockSize] = input[b % kInputBlocks];
+    for (size_t i = 0; i < kBlockSize; i++) {
+        float sum = 0.0f;
+        for (size_t v = 0; v < num_voices; v++) {
+            svfs[v].Process(in[v][i]);
+            sum += svfs[v].Low();
+        }
+        out[i] = sum;
+    }
+}
+
+template <size_t Lanes>
+void RenderLanes(size_t first, const float (*in)[kBlockSize], float* out) {
+    SvfBank<kMaxVoices>::Lane lane[Lanes];
+    for (size_t k = 0; k < Lanes; k++) lane[k] = bank.Load(first + k);
+    for (size_t i = 0; i < kBlockSize; i++) {
+        float sum = 0.0f;
+        for (size_t k = 0; k < Lanes; k++) sum += lane[k].Process(in[first + k][i]);
+        out[i] += sum;
+    }
+    for (size_t k = 0; k < Lanes; k++) bank.Store(first + k, lane[k]);
+}
+
+// SvfBank: table cutoffs, then kLanes voices at a time through the block
+void RenderBank(size_t num_voices, size_t b, float* out) {
+    for (size_t v = 0; v < num_voices; v++) bank.SetCutoff(v, Cutoff(v, b));
+    const float (*in)[kBlockSize] = input[b % kInputBlocks];
+    for (size_t i = 0; i < kBlockSize; i++) out[i] = 0.0f;
+    size_t v = 0;
+    for (; v + kLanes <= num_voices; v += kLanes) RenderLanes<kLanes>(v, in, out);
+    switch (num_voices - v) {
+        case 3: RenderLanes<3>(v, in, out); break;
+        case 2: RenderLanes<2>(v, in, out); break;
+        case 1: RenderLanes<1>(v, in, out); break;
+        default: break;
+    }
+}
+
+template <typename F>
+double UsPerBlock(size_t blocks, F render) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t b = 0; b < blocks; b++) render(b);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(t1 - t0).count() / static_cast<double>(blocks);
+}
+
+// Largest relative error of the bank's tuning coefficient against Svf::SetFreq
+double CoefficientError() {
+    const float max_cutoff = kSampleRate / 3.0f;
+    SvfBank<1> one;
+    one.Init(kSampleRate, 0.1f);
+    daisysp::Svf svf;
+    svf.Init(kSampleRate);
+    svf.SetRes(0.1f);
+    double worst = 0.0;
+    for (int i = 1; i <= 100000; i++) {
+        const float hz = max_cutoff * static_cast<float>(i) / 100000.0f;
+        one.SetCutoff(0, hz);
+        const float exact = 2.0f * sinf(3.14159265f * fminf(0.25f, hz / (kSampleRate * 2.0f)));
+        const double err = fabs(static_cast<double>(one.Load(0).f) - exact) / exact;
+        if (err > worst) worst = err;
+    }
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t num_voices = argc > 1 ? static_cast<size_t>(atoi(argv[1])) : 16;
+    const size_t blocks = argc > 2 ? static_cast<size_t>(atoi(argv[2])) : 50000;
+    if (num_voices < 1) num_voices = 1;
+    if (num_voices > kMaxVoices) num_voices = kMaxVoices;
+
+    // Naive saws at spread pitches, as the oscillators would feed the filters, and cutoffs
+    // sweeping like the voices' 2x fundamental + z * 7 kHz
+    for (size_t v = 0; v < kMaxVoices; v++) {
+        for (size_t b = 0; b < kInputBlocks; b++) {
+            const float t = static_cast<float>(b) * 0.05f + static_cast<float>(v) * 0.7f;
+            cutoffs[b][v] = 400.0f + 7000.0f * (0.5f + 0.5f * sinf(t));
+        }
+        float phase = 0.0f;
+        const float inc = (110.0f + 37.0f * static_cast<float>(v)) / kSampleRate;
+        for (size_t b = 0; b < kInputBlocks; b++) {
+            for (size_t i = 0; i < kBlockSize; i++) {
+                phase += inc;
+                if (phase >= 1.0f) phase -= 1.0f;
+                input[b][v][i] = 2.0f * phase - 1.0f;
+            }
+        }
+    }
+
+    Init();
+    float sink = 0.0f;
+    const double svf_coeff_us = UsPerBlock(blocks, [&](size_t b) {
+        for (size_t v = 0; v < num_voices; v++) svfs[v].SetFreq(Cutoff(v, b));
+        sink += svfs[0].Low();
+    });
+    const double bank_coeff_us = UsPerBlock(blocks, [&](size_t b) {
+        for (size_t v = 0; v < num_voices; v++) bank.SetCutoff(v, Cutoff(v, b));
+        sink += bank.Load(0).f;
+    });
+
+    static float out_svf[kBlockSize], out_bank[kBlockSize];
+    Init();
+    const double svf_us = UsPerBlock(blocks, [&](size_t b) {
+        RenderSvf(num_voices, b, out_svf);
+        sink += out_svf[0];
+    });
+    Init();
+    const double bank_us = UsPerBlock(blocks, [&](size_t b) {
+        RenderBank(num_voices, b, out_bank);
+        sink += out_bank[0];
+    });
+    if (sink == 12345.0f) printf(" ");  // keep the work from being optimized out
+
+    // Same input and cutoffs through both, compared sample by sample
+    Init();
+    float max_diff = 0.0f, peak = 0.0f;
+    for (size_t b = 0; b < 4000; b++) {
+        RenderSvf(num_voices, b, out_svf);
+        RenderBank(num_voices, b, out_bank);
+        for (size_t i = 0; i < kBlockSize; i++) {
+            max_diff = fmaxf(max_diff, fabsf(out_svf[i] - out_bank[i]));
+            peak     = fmaxf(peak, fabsf(out_svf[i]));
+        }
+    }
+
+    printf("%zu voices, %zu-sample blocks, cutoff changing every block\n", num_voices, kBlockSize);
+    printf("cutoff updates:     Svf::SetFreq %6.2f us/block, SvfBank table %6.2f us/block (%.1fx)\n",
+           svf_coeff_us, bank_coeff_us, svf_coeff_us / bank_coeff_us);
+    printf("updates + filter:   per-voice Svf %6.2f us/block, SvfBank lockstep %6.2f us/block (%.1fx)\n",
+           svf_us, bank_us, svf_us / bank_us);
+    printf("coefficient error:  %.2e (relative, 0 - %.0f Hz)\n", CoefficientError(),
+           static_cast<double>(kSampleRate / 3.0f));
+    printf("output difference:  %.2e (peak %.3f)\n", static_cast<double>(max_diff),
+           static_cast<double>(peak));
+    return 0;
+}
@@ -0,0 +1,168 @@
+// Host tool for performance traces (see boids/flock_trace.h).
+//   ./trace_tool record <seconds> <file> [boids]  simulate a scripted performance the way
+//                                                  the firmware main loop does and save it
+//   ./trace_tool <file>                            decode and summarize a trace
+// Recording also decodes the result and reports the worst quantization error against the
+// live flock, so it doubles as a round-trip check of the codec.
+#include "flock_trace.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace murmur;
+
+namespace {
+
+BoidsFlock<MAX_BOIDS> flock;
+
+struct LiveFrame {
+    std::vector<Vec3> pos;
+    std::vector<Vec3> vel;
+};
+
+int Record(float seconds, const char* path, size_t num_boids) {
+    static std::vector<uint8_t> buffer(64 * 1024 * 1024);
+    TraceWriter writer;
+    writer.Init(buffer.data(), buffer.size());
+
+    BoidsParams params;
+    params.separation_weight = 1.0f;
+    params.alignment_weight  = 1.0f;
+    params.cohesion_weight   = 1.0f;
+    params.perception_radius = 0.25f;
+    params.max_speed         = 0.3f;
+    params.max_force         = 0.15f;
+    params.neighbor_search   = NeighborSearch::VERLET;
+    params.adaptive_step     = true;
+    params.lod_stride        = 4;
+    flock.Init(num_boids);
+
+    // Main-loop emulation: 1 ms loop, flock every 2 ms, a slow knob sweep on CTRL_3
+    // (speed) and CTRL_1 (density), and a scatter every 20 s
+    std::vector<LiveFrame> live;
+    const uint32_t end_ms = static_cast<uint32_t>(seconds * 1000.0f);
+    uint32_t last_update = 0;
+    int32_t  knobs[2] = {-1, -1};
+    for (uint32_t now = 1; now <= end_ms; now++) {
+        const float t = static_cast<float>(now) * 0.001f;
+        const int32_t speed   = static_cast<int32_t>((0.5f + 0.5f * sinf(t * 0.05f)) * 65535.0f);
+        const int32_t density = static_cast<int32_t>((0.5f + 0.4f * sinf(t * 0.13f)) * 65535.0f);
+        const int32_t values[2] = {density, speed};
+        for (int k = 0; k < 2; k++) {
+            if (knobs[k] < 0 || std::abs(values[k] - knobs[k]) >= 64) {
+                knobs[k] = values[k];
+                writer.WriteEvent(now, {TraceEventType::KNOB, static_cast<uint8_t>(k * 2), values[k]});
+            }
+        }
+        const float v_density = static_cast<float>(knobs[0]) / 65535.0f;
+        params.separation_weight = v_density * 2.0f;
+        params.cohesion_weight   = (1.0f - v_density) * 2.0f;
+        params.max_speed = 0.05f + static_cast<float>(knobs[1]) / 65535.0f * 1.45f;
+        params.max_force = params.max_speed * 0.5f;
+
+        if (now % 20000 == 0) {
+            writer.WriteEvent(now, {TraceEventType::GATE, 1, 0});
+            flock.Scatter();
+        }
+
+        if (now - last_update >= 2) {
+            size_t steps = flock.Advance(static_cast<float>(now - last_update) * 0.001f, params);
+            if (steps > 0 && writer.WriteFrame(now, flock)) {
+                LiveFrame f;
+                for (size_t i = 0; i < flock.GetNumBoids(); i++) {
+                    f.pos.push_back(flock.GetPosition(i));
+                    f.vel.push_back(flock.GetVelocity(i));
+                }
+                live.push_back(f);
+            }
+            last_update = now;
+        }
+    }
+
+    FILE* out = fopen(path, "wb");
+    if (!out) {
+        perror(path);
+        return 1;
+    }
+    fwrite(writer.GetData(), 1, writer.GetSize(), out);
+    fclose(out);
+
+    // Round trip: decode and compare every frame with the live state
+    TraceReader reader;
+    if (!reader.Init(writer.GetData(), writer.GetSize())) {
+        fprintf(stderr, "bad header\n");
+        return 1;
+    }
+    TraceRecord record;
+    size_t frame = 0;
+    float pos_err = 0.0f;
+    float vel_err = 0.0f;
+    while (reader.Next(record)) {
+        if (record.type == TraceRecordType::EVENT) continue;
+        const LiveFrame& f = live[frame++];
+        for (size_t i = 0; i < reader.GetNumBoids(); i++) {
+            Vec3 dp = reader.GetPosition(i) - f.pos[i];
+            Vec3 dv = reader.GetVelocity(i) - f.vel[i];
+            pos_err = fmaxf(pos_err, fmaxf(fabsf(dp.x), fmaxf(fabsf(dp.y), fabsf(dp.z))));
+            vel_err = fmaxf(vel_err, fmaxf(fabsf(dv.x), fmaxf(fabsf(dv.y), fabsf(dv.z))));
+        }
+    }
+
+    const double bytes_per_s = static_cast<double>(writer.GetSize()) / seconds;
+    printf("%zu boids, %.0f s: %u frames, %zu bytes (%.0f B/s, %.2f bytes/boid/frame)\n",
+           num_boids, static_cast<double>(seconds), writer.GetFrames(), writer.GetSize(),
+           bytes_per_s, static_cast<double>(writer.GetSize()) / writer.GetFrames() / num_boids);
+    printf("16 MB holds %.1f hours\n", 16.0 * 1024 * 1024 / bytes_per_s / 3600.0);
+    printf("decoded %zu/%zu frames, max error pos %.2e vel %.2e%s\n", frame, live.size(),
+           static_cast<double>(pos_err), static_cast<double>(vel_err),
+           frame == live.size() ? "" : "  MISMATCH");
+    return frame == live.size() ? 0 : 1;
+}
+
+int Summarize(const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0) data.insert(data.end(), chunk, chunk + n);
+    fclose(in);
+
+    TraceReader reader;
+    if (!reader.Init(data.data(), data.size())) {
+        fprintf(stderr, "%s: not a trace (or unsupported version)\n", path);
+        return 1;
+    }
+    TraceRecord record;
+    size_t keyframes = 0, frames = 0, events[5] = {0, 0, 0, 0, 0};
+    uint32_t end_ms = 0;
+    while (reader.Next(record)) {
+        end_ms = record.time_ms;
+        if (record.type == TraceRecordType::KEYFRAME) keyframes++;
+        if (record.type == TraceRecordType::FRAME) frames++;
+        if (record.type == TraceRecordType::EVENT) events[static_cast<int>(record.event.type)]++;
+    }
+    printf("%s: %zu bytes, %.1f s, %zu keyframes + %zu frames, %zu boids\n", path, data.size(),
+           end_ms * 0.001, keyframes, frames, reader.GetNumBoids());
+    printf("events: %zu knob, %zu encoder turn, %zu encoder press, %zu gate, %zu chord\n",
+           events[0], events[1], events[2], events[3], events[4]);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc >= 4 && strcmp(argv[1], "record") == 0) {
+        size_t boids = (argc > 4) ? static_cast<size_t>(atoi(argv[4])) : 8;
+        if (boids > MAX_BOIDS) boids = MAX_BOIDS;
+        return Record(static_cast<float>(atof(argv[2])), argv[3], boids);
+    }
+    if (argc == 2) return Summarize(argv[1]);
+    fprintf(stderr, "usage: %s record <seconds> <file> [boids] | %s <file>\n", argv[0], argv[0]);
+    return 2;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#ifndef QSPI_FLASH_H
+#define QSPI_FLASH_H
+
+#include "daisy_seed.h"
+#include <cstdint>
+
+namespace murmur {
+
+// SnapshotStore flash backend on the Daisy Seed's 8 MB QSPI chip. Erase and Write block
+// until the chip is done (a 4 KB sector erase is typically 45 ms and at most 300 ms, a
+// page ~0.5 ms), which is why the store issues one of them per main-loop pass, and only
+// from UpdateSnapshot() once a save is due. Audio keeps running: the callback is
+// interrupt-driven and executes from internal flash.
+class QspiFlash {
+public:
+    explicit QspiFlash(daisy::QSPIHandle& qspi) : qspi_(qspi) {}
+
+    bool Erase(uint32_t offset, uint32_t size) {
+        return qspi_.Erase(offset, offset + size) == daisy::QSPIHandle::Result::OK;
+    }
+
+    bool Write(uint32_t offset, const uint8_t* data, uint32_t size) {
+        return qspi_.Write(offset, size, const_cast<uint8_t*>(data))
+               == daisy::QSPIHandle::Result::OK;
+    }
+
+    const uint8_t* Read(uint32_t offset) const {
+        return static_cast<const uint8_t*>(qspi_.GetData(offset));
+    }
+
+private:
+    daisy::QSPIHandle& qspi_;
+};
+
+} // namespace murmur
+
+#endif // QSPI_FLASH_H
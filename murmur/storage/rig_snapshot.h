@@ -0,0 +1,129 @@
+#pragma once
+#ifndef RIG_SNAPSHOT_H
+#define RIG_SNAPSHOT_H
+
+#include "snapshot_store.h"
+#include "../audio/scale_quantizer.h"
+#include "../audio/chord_progression.h"
+#include "../audio/axis_mapping.h"
+#include "../boids/flock_trace.h"
+#include <cstdint>
+#include <cstddef>
+
+namespace murmur {
+
+// Bump whenever RigSnapshot's layout or meaning changes: older snapshots are then ignored
+// and the rig cold-starts once.
+constexpr uint16_t RIG_SNAPSHOT_VERSION = 1;
+
+// Settings restored at power-up. Knob-driven parameters are not stored: the knobs are
+// read again at boot.
+struct RigSettings {
+    uint8_t root;
+    uint8_t scale;
+    uint8_t base_octave;
+    uint8_t chord_mode;
+    uint8_t chord_index;
+    uint8_t axis_x;
+    uint8_t axis_y;
+    uint8_t axis_z;
+    uint8_t num_boids;
+    uint8_t reserved;  // zero (keeps the boid arrays aligned, no padding in the CRC)
+};
+
+// The rig as it was: settings plus the flock in flight, quantized like trace keyframes
+// (16 bits per component, 12 bytes per boid).
+struct RigSnapshot {
+    RigSettings settings;
+    uint16_t pos[MAX_BOIDS][3];
+    int16_t  vel[MAX_BOIDS][3];
+};
+
+static_assert(sizeof(RigSnapshot) <= SNAPSHOT_MAX_PAYLOAD,
+              "rig snapshot must fit one flash sector");
+
+// Whether a change is worth a save of its own. The chord index is left out: a running
+// progression advances it every 10-15 s, and the periodic save picks it up.
+inline bool SameSettings(const RigSettings& a, const RigSettings& b) {
+    return a.root == b.root && a.scale == b.scale && a.base_octave == b.base_octave
+        && a.chord_mode == b.chord_mode && a.axis_x == b.axis_x && a.axis_y == b.axis_y
+        && a.axis_z == b.axis_z && a.num_boids == b.num_boids;
+}
+
+inline RigSettings CaptureSettings(const ScaleQuantizer& sq, const ChordProgression& chord,
+                                   const AxisMapping& axes, int num_boids) {
+    RigSettings s;
+    s.root        = static_cast<uint8_t>(sq.GetRoot());
+    s.scale       = static_cast<uint8_t>(sq.GetScale());
+    s.base_octave = static_cast<uint8_t>(sq.GetBaseOctave());
+    s.chord_mode  = static_cast<uint8_t>(chord.GetMode());
+    s.chord_index = static_cast<uint8_t>(chord.GetIndex());
+    s.axis_x      = static_cast<uint8_t>(axes.x);
+    s.axis_y      = static_cast<uint8_t>(axes.y);
+    s.axis_z      = static_cast<uint8_t>(axes.z);
+    s.num_boids   = static_cast<uint8_t>(num_boids);
+    s.reserved    = 0;
+    return s;
+}
+
+// Applies stored settings; out-of-range values (a corrupt or foreign snapshot that still
+// passed its CRC) fall back to the defaults. The boid count is left to the caller.
+inline void ApplySettings(const RigSettings& s, uint32_t now, ScaleQuantizer& sq,
+                          ChordProgression& chord, AxisMapping& axes) {
+    const ScaleQuantizer defaults;
+    sq.SetRoot(s.root);
+    sq.SetScale(s.scale < static_cast<uint8_t>(ScaleType::COUNT)
+                ? static_cast<ScaleType>(s.scale) : defaults.GetScale());
+    sq.SetBaseOctave(s.base_octave);
+    chord.Restore(s.chord_mode, s.chord_index, now, sq);
+
+    const AxisMapping default_axes;
+    auto param = [](uint8_t p, Param fallback) {
+        return p <= static_cast<uint8_t>(Param::PAN) ? static_cast<Param>(p) : fallback;
+    };
+    axes.x = param(s.axis_x, default_axes.x);
+    axes.y = param(s.axis_y, default_axes.y);
+    axes.z = param(s.axis_z, default_axes.z);
+}
+
+// FlockT needs GetNumBoids / GetPosition / GetVelocity
+template <typename FlockT>
+void CaptureFlock(const FlockT& flock, RigSnapshot& snap) {
+    size_t num = flock.GetNumBoids();
+    if (num > MAX_BOIDS) num = MAX_BOIDS;
+    for (size_t i = 0; i < num; i++) {
+        const Vec3 p = flock.GetPosition(i);
+        const Vec3 v = flock.GetVelocity(i);
+        snap.pos[i][0] = TraceWriter::QuantizePosition(p.x);
+        snap.pos[i][1] = TraceWriter::QuantizePosition(p.y);
+        snap.pos[i][2] = TraceWriter::QuantizePosition(p.z);
+        snap.vel[i][0] = TraceWriter::QuantizeVelocity(v.x);
+        snap.vel[i][1] = TraceWriter::QuantizeVelocity(v.y);
+        snap.vel[i][2] = TraceWriter::QuantizeVelocity(v.z);
+    }
+    for (size_t i = num; i < MAX_BOIDS; i++) {
+        snap.pos[i][0] = snap.pos[i][1] = snap.pos[i][2] = 0;
+        snap.vel[i][0] = snap.vel[i][1] = snap.vel[i][2] = 0;
+    }
+}
+
+// Restores boid states into a flock already sized to the stored count (FlockT needs
+// GetNumBoids / SetBoidState)
+template <typename FlockT>
+void RestoreFlock(FlockT& flock, const RigSnapshot& snap) {
+    size_t num = flock.GetNumBoids();
+    if (num > snap.settings.num_boids) num = snap.settings.num_boids;
+    for (size_t i = 0; i < num; i++) {
+        flock.SetBoidState(i,
+            Vec3(TraceReader::DequantizePosition(snap.pos[i][0]),
+                 TraceReader::DequantizePosition(snap.pos[i][1]),
+                 TraceReader::DequantizePosition(snap.pos[i][2])),
+            Vec3(TraceReader::DequantizeVelocity(snap.vel[i][0]),
+                 TraceReader::DequantizeVelocity(snap.vel[i][1]),
+                 TraceReader::DequantizeVelocity(snap.vel[i][2])));
+    }
+}
+
+} // namespace murmur
+
+#endif // RIG_SNAPSHOT_H
@@ -0,0 +1,185 @@
+#pragma once
+#ifndef SNAPSHOT_STORE_H
+#define SNAPSHOT_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace murmur {
+
+// Flash geometry of the Daisy Seed QSPI chip (IS25LP064), shared with the host stand-in:
+// 4 KB erase sectors, 256 B program pages. Erased bytes read 0xFF; programming only
+// clears bits.
+constexpr uint32_t FLASH_SECTOR_BYTES = 4096;
+constexpr uint32_t FLASH_PAGE_BYTES   = 256;
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x504E534Du;  // "MSNP"
+
+// Start of every snapshot sector
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t sequence;  // +1 per save; the newest valid sector wins
+    uint16_t version;   // payload layout version (caller-defined)
+    uint16_t size;      // payload bytes
+    uint32_t crc;       // CRC-32 of the payload
+};
+
+constexpr size_t SNAPSHOT_MAX_PAYLOAD = FLASH_SECTOR_BYTES - sizeof(SnapshotHeader);
+
+// CRC-32 (IEEE, reflected), four bits per step from a 16-entry table
+inline uint32_t Crc32(const uint8_t* data, size_t size) {
+    static const uint32_t kTable[16] = {
+        0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu,
+        0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+        0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu,
+        0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+    };
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ kTable[crc & 15u];
+        crc = (crc >> 4) ^ kTable[crc & 15u];
+    }
+    return ~crc;
+}
+
+// Versioned snapshots in a ring of flash sectors, one snapshot per sector.
+//
+// Wear leveling: each save goes to the sector after the newest one, so every sector is
+// erased once per num_sectors saves. A save cut short by power loss leaves a sector
+// without a valid header or CRC, and Load() still finds the snapshot before it.
+//
+// Writes run in the background: Save() only stages the snapshot in RAM, and each Poll()
+// performs one flash operation - the sector erase, then one page per call, the page
+// holding the header last so a sector only becomes valid once it is complete.
+//
+// Flash provides Erase(offset, size), Write(offset, data, size) (both returning true on
+// success) and Read(offset), a pointer to the memory-mapped contents. Offsets are from
+// the start of the chip and sector aligned.
+template <typename Flash>
+class SnapshotStore {
+public:
+    SnapshotStore() : flash_(nullptr), base_(0), num_sectors_(0), newest_(-1), sequence_(0),
+                      state_(State::IDLE), target_(0), page_(0), num_pages_(0) {}
+
+    // Scans the ring for the newest valid snapshot. Reads flash, so call it before the
+    // first save (the store never reads flash after that).
+    void Init(Flash* flash, uint32_t base, uint32_t num_sectors) {
+        flash_       = flash;
+        base_        = base;
+        num_sectors_ = num_sectors;
+        newest_      = -1;
+        sequence_    = 0;
+        state_       = State::IDLE;
+
+        for (uint32_t s = 0; s < num_sectors_; s++) {
+            const uint8_t* sector = flash_->Read(SectorOffset(s));
+            SnapshotHeader header;
+            memcpy(&header, sector, sizeof(header));
+            if (header.magic != SNAPSHOT_MAGIC || header.size > SNAPSHOT_MAX_PAYLOAD) continue;
+            if (Crc32(sector + sizeof(header), header.size) != header.crc) continue;
+            if (newest_ < 0 || header.sequence > sequence_) {
+                newest_   = static_cast<int32_t>(s);
+                sequence_ = header.sequence;
+            }
+        }
+    }
+
+    // Copies the newest snapshot into out. False if there is none, or if it was written
+    // with another payload version or size (a firmware update changed the layout).
+    bool Load(uint16_t version, void* out, size_t size) const {
+        if (newest_ < 0) return false;
+        const uint8_t* sector = flash_->Read(SectorOffset(static_cast<uint32_t>(newest_)));
+        SnapshotHeader header;
+        memcpy(&header, sector, sizeof(header));
+        if (header.version != version || header.size != size) return false;
+        memcpy(out, sector + sizeof(header), size);
+        return true;
+    }
+
+    // Stages a snapshot for writing. False while the previous one is still being written.
+    bool Save(uint16_t version, const void* data, size_t size) {
+        if (state_ != State::IDLE || flash_ == nullptr || num_sectors_ == 0
+            || size > SNAPSHOT_MAX_PAYLOAD) {
+            return false;
+        }
+        SnapshotHeader header;
+        header.magic    = SNAPSHOT_MAGIC;
+        header.sequence = sequence_ + 1;
+        header.version  = version;
+        header.size     = static_cast<uint16_t>(size);
+        header.crc      = Crc32(static_cast<const uint8_t*>(data), size);
+        memcpy(staging_, &header, sizeof(header));
+        memcpy(staging_ + sizeof(header), data, size);
+
+        const uint32_t bytes = static_cast<uint32_t>(sizeof(header) + size);
+        num_pages_ = (bytes + FLASH_PAGE_BYTES - 1) / FLASH_PAGE_BYTES;
+        target_    = newest_ < 0 ? 0 : (static_cast<uint32_t>(newest_) + 1) % num_sectors_;
+        state_     = State::ERASE;
+        return true;
+    }
+
+    // Main loop: at most one flash operation per call. A failed operation drops the save;
+    // the next Save() retries the same sector.
+    void Poll() {
+        switch (state_) {
+            case State::ERASE:
+                if (!flash_->Erase(SectorOffset(target_), FLASH_SECTOR_BYTES)) {
+                    state_ = State::IDLE;
+                    break;
+                }
+                page_  = num_pages_ > 1 ? 1 : 0;
+                state_ = State::PROGRAM;
+                break;
+
+            case State::PROGRAM: {
+                const uint32_t offset = page_ * FLASH_PAGE_BYTES;
+                const uint32_t bytes  = static_cast<uint32_t>(sizeof(SnapshotHeader))
+                                      + reinterpret_cast<const SnapshotHeader*>(staging_)->size;
+                const uint32_t len    = bytes - offset < FLASH_PAGE_BYTES ? bytes - offset
+                                                                          : FLASH_PAGE_BYTES;
+                if (!flash_->Write(SectorOffset(target_) + offset, staging_ + offset, len)) {
+                    state_ = State::IDLE;
+                    break;
+                }
+                if (page_ == 0) {
+                    // Header page written: the sector is now the newest snapshot
+                    newest_   = static_cast<int32_t>(target_);
+                    sequence_ = sequence_ + 1;
+                    state_    = State::IDLE;
+                } else {
+                    page_ = (page_ + 1 < num_pages_) ? page_ + 1 : 0;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    bool IsBusy() const { return state_ != State::IDLE; }
+    bool HasSnapshot() const { return newest_ >= 0; }
+    uint32_t GetSequence() const { return sequence_; }
+
+private:
+    enum class State : uint8_t { IDLE, ERASE, PROGRAM };
+
+    uint32_t SectorOffset(uint32_t sector) const { return base_ + sector * FLASH_SECTOR_BYTES; }
+
+    Flash*   flash_;
+    uint32_t base_;
+    uint32_t num_sectors_;
+    int32_t  newest_;     // sector of the newest valid snapshot, -1 = none
+    uint32_t sequence_;   // its sequence number
+    State    state_;
+    uint32_t target_;     // sector being written
+    uint32_t page_;       // next page to program
+    uint32_t num_pages_;
+    alignas(4) uint8_t staging_[FLASH_SECTOR_BYTES];
+};
+
+} // namespace murmur
+
+#endif // SNAPSHOT_STORE_H
@@ -85,19 +85,32 @@ void Display::DrawBoid(const Boid& boid, bool highlight) {
     }
 }
 
-void Display::DrawFlockView(const BoidsFlock& flock, const BoidsParams& params,
-                             const char* chord_label) {
+void Display::DrawFlockView(const Flock& flock, const BoidsParams& params,
+                            const char* chord_label) {
     Clear();
     DrawTitle("MURMUR BOIDS");
 
     // Draw border for flock area
     patch_->display.DrawRect(0, 10, 127, 63, true, false);
 
-    // Draw all boids
+    // Draw all boids at their interpolated (between-step) positions
     for (size_t i = 0; i < flock.GetNumBoids(); i++) {
-        DrawBoid(flock.GetBoid(i), i == 0);
+        Boid boid = flock.GetBoid(i);
+        boid.position = flock.GetInterpolatedPosition(i);
+        DrawBoid(boid, i == 0);
     }
 
+    // Flock centroid as a small cross (from the shared analytics pass)
+    const Vec3& c = flock.GetAnalytics().centroid;
+    int cx = static_cast<int>(c.x * 127);
+    int cy = 63 - static_cast<int>(c.y * 53);
+    if (cx < 2) cx = 2;
+    if (cx > 125) cx = 125;
+    if (cy < 12) cy = 12;
+    if (cy > 61) cy = 61;
+    patch_->display.DrawLine(cx - 2, cy, cx + 2, cy, true);
+    patch_->display.DrawLine(cx, cy - 2, cx, cy + 2, true);
+
     char str[16];
 
     // Show active chord + root note (e.g. "I:A", "IV:D#") when chord prog is running.
@@ -117,7 +130,7 @@ void Display::DrawFlockView(const BoidsFlock& flock, const BoidsParams& params,
 }
 
 void Display::DrawParameters(const BoidsParams& params, size_t num_boids,
-                              float morph) {
+                              float morph, int live_voices, float cpu_load) {
     Clear();
     DrawTitle("MURMUR PARAMS");
 
@@ -160,6 +173,17 @@ void Display::DrawParameters(const BoidsParams& params, size_t num_boids,
     snprintf(str, sizeof(str), "Boids: %d", static_cast<int>(num_boids));
     patch_->display.WriteString(str, Font_6x8, true);
 
+    // Voices still rendering (incl. fading out) and audio callback load
+    if (cpu_load >= 0.0f) {
+        patch_->display.SetCursor(64, 36);
+        snprintf(str, sizeof(str), "Live: %d", live_voices);
+        patch_->display.WriteString(str, Font_6x8, true);
+
+        patch_->display.SetCursor(86, 0);
+        snprintf(str, sizeof(str), "CPU%d%%", static_cast<int>(cpu_load * 100.0f + 0.5f));
+        patch_->display.WriteString(str, Font_6x8, true);
+    }
+
     // Mapping info
     patch_->display.SetCursor(0, 46);
     patch_->display.WriteString("x:pan y:freq z:amp", Font_6x8, true);
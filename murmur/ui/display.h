@@ -3,7 +3,7 @@
 #define DISPLAY_H
 
 #include "daisy_patch.h"
-#include "../boids/boids.h"
+#include "../boids/flock.h"
 
 namespace murmur {
 
@@ -25,10 +25,12 @@ public:
     DisplayPage GetPage() const { return current_page_; }
 
     // chord_label: nullptr or "" when inactive; "I"/"IV"/"V" when chord prog is running.
-    void DrawFlockView(const BoidsFlock& flock, const BoidsParams& params,
+    void DrawFlockView(const Flock& flock, const BoidsParams& params,
                        const char* chord_label = nullptr);
-    // morph: 0=sine, 1=triangle, 2=square
-    void DrawParameters(const BoidsParams& params, size_t num_boids, float morph);
+    // morph: 0=sine, 1=triangle, 2=square. live_voices / cpu_load (0-1): shown when
+    // cpu_load >= 0 (builds with audio).
+    void DrawParameters(const BoidsParams& params, size_t num_boids, float morph,
+                        int live_voices = 0, float cpu_load = -1.0f);
     // chord_prog_mode: 0=OFF, 1=10s, 2=15s. chord_index: 0-3 (I/IV/V/I).
     void DrawScaleSettings(int root, int scale_idx, int base_oct,
                            int cursor, int span_oct, float freq_range,
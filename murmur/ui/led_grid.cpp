@@ -25,13 +25,14 @@ void LedGrid::SetLed(size_t x, size_t y, float brightness) {
     brightness_[x][y] = brightness;
 }
 
-void LedGrid::UpdateFromFlock(const BoidsFlock& flock) {
+void LedGrid::UpdateFromFlock(const Flock& flock) {
     // Map boid density to LED brightness
-    // The grid cells in BoidsFlock match our LED grid (4x4)
+    // The flock's analytics density grid matches our LED grid (4x4)
+    const FlockAnalytics& stats = flock.GetAnalytics();
 
     for (size_t x = 0; x < LED_GRID_WIDTH; x++) {
         for (size_t y = 0; y < LED_GRID_HEIGHT; y++) {
-            int density = flock.GetCellDensity(x, y);
+            int density = stats.density[x][y];
 
             // Map density to brightness
             // Max reasonable density is about 4 boids per cell
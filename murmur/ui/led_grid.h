@@ -3,14 +3,14 @@
 #define LED_GRID_H
 
 #include "daisy_patch.h"
-#include "../boids/boids.h"
+#include "../boids/flock.h"
 
 namespace murmur {
 
 // Daisy Patch has a 4x4 LED grid (accent LEDs via shift register)
 // Note: The actual LED control might need adjustment based on hardware
-constexpr size_t LED_GRID_WIDTH = 4;
-constexpr size_t LED_GRID_HEIGHT = 4;
+constexpr size_t LED_GRID_WIDTH = LED_GRID_DIM;
+constexpr size_t LED_GRID_HEIGHT = LED_GRID_DIM;
 
 class LedGrid {
 public:
@@ -20,7 +20,7 @@ public:
     void Init(daisy::DaisyPatch* patch);
 
     // Update LED brightness based on boid density in each cell
-    void UpdateFromFlock(const BoidsFlock& flock);
+    void UpdateFromFlock(const Flock& flock);
 
     // Set individual LED brightness (0-1)
     void SetLed(size_t x, size_t y, float brightness);